@@ -0,0 +1,126 @@
+/* Arduino core & FastLED functions for the host build, see include/Arduino.h & include/FastLED.h */
+
+#include <chrono>
+#include <thread>
+#include "Arduino.h"
+#include "FastLED.h"
+
+HostSerial Serial;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+uint32_t micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint32_t millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+long random(long howBig) {
+  return howBig > 0 ? rand() % howBig : 0;
+}
+
+long random(long howSmall, long howBig) {
+  return howSmall < howBig ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) {
+    srand(seed);
+  }
+}
+
+size_t HostSerial::write(uint8_t data) {
+  return fwrite(&data, 1, 1, stderr);
+}
+
+size_t HostSerial::write(const uint8_t data[], size_t size) {
+  return fwrite(data, 1, size, stderr);
+}
+
+size_t HostSerial::print(const char text[]) {
+  return fputs(text, stderr) < 0 ? 0 : strlen(text);
+}
+
+size_t HostSerial::print(char c) {
+  return write(uint8_t(c));
+}
+
+size_t HostSerial::print(long number, int base) {
+  if (base == DEC) {
+    return fprintf(stderr, "%ld", number);
+  }
+  return print((unsigned long)number, base);
+}
+
+size_t HostSerial::print(unsigned long number, int base) {
+  return fprintf(stderr, base == HEX ? "%lX" : "%lu", number);
+}
+
+size_t HostSerial::print(double number, int digits) {
+  return fprintf(stderr, "%.*f", digits, number);
+}
+
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb) {
+  // FastLED hsv2rgb.cpp, yellow boost Y1, no green scaling
+  const uint8_t hue = hsv.hue;
+  const uint8_t sat = hsv.sat;
+  uint8_t val = hsv.val;
+
+  const uint8_t offset8 = (hue & 0x1F) << 3;
+  const uint8_t third = scale8(offset8, 256 / 3); // max = 85
+  const uint8_t twoThirds = scale8(offset8, (256 * 2) / 3); // max = 170
+  uint8_t r, g, b;
+
+  switch (hue >> 5) {
+    case 0: r = 255 - third; g = third; b = 0; break; // R -> O
+    case 1: r = 171; g = 85 + third; b = 0; break; // O -> Y
+    case 2: r = 171 - twoThirds; g = 170 + third; b = 0; break; // Y -> G
+    case 3: r = 0; g = 255 - third; b = third; break; // G -> A
+    case 4: r = 0; g = 171 - twoThirds; b = 85 + twoThirds; break; // A -> B
+    case 5: r = third; g = 0; b = 255 - third; break; // B -> P
+    case 6: r = 85 + third; g = 0; b = 171 - third; break; // P -> K
+    default: r = 170 + third; g = 0; b = 85 - third; break; // K -> R
+  }
+
+  if (sat != 255) {
+    if (sat == 0) {
+      r = 255;
+      g = 255;
+      b = 255;
+    } else {
+      uint8_t desat = 255 - sat;
+      desat = scale8_video(desat, desat);
+      uint8_t satScale = 255 - desat;
+      r = scale8(r, satScale) + desat;
+      g = scale8(g, satScale) + desat;
+      b = scale8(b, satScale) + desat;
+    }
+  }
+
+  if (val != 255) {
+    val = scale8_video(val, val);
+    if (val == 0) {
+      r = 0;
+      g = 0;
+      b = 0;
+    } else {
+      r = scale8(r, val);
+      g = scale8(g, val);
+      b = scale8(b, val);
+    }
+  }
+
+  rgb.r = r;
+  rgb.g = g;
+  rgb.b = b;
+}
@@ -0,0 +1,240 @@
+/* Regression checks of the host build: `make check` (see Makefile)
+   The generated sketch source is compiled into this file, so the checks can reach every function & global of the sketch.
+   Frames are not shown: hostShowStrip() does nothing. setup() / loop() are only called by the last checks.
+   Each check prints its result, the exit code is the number of failed checks.
+*/
+
+#include "LEDPiano.cpp"
+
+void hostShowStrip(const CRGB strip[], uint16_t num, uint32_t inputTime) {}
+
+static int failedNum = 0;
+
+static void report(const char* name, bool passed) {
+  printf("%s %s\n", passed ? "ok  " : "FAIL", name);
+  if (!passed) {
+    ++failedNum;
+  }
+}
+
+static void checkEnergy() {
+  // Saturated impulses decay, the level follows them down again
+  energyImpulse = 0xFFFF;
+  energyLevel = 0xFFFF;
+  for (uint8_t b = 0; b < ENERGY_BAND_NUM; ++b) {
+    bandImpulse[b] = 0xFFFF;
+    bandLevel[b] = 0xFFFF;
+  }
+  updateEnergy();
+  report("saturated energy impulse decays", energyImpulse < 0xFFFF && bandImpulse[0] < 0xFFFF);
+  for (uint16_t f = 0; f < 2000; ++f) {
+    updateEnergy();
+  }
+  report("saturated energy level falls to 0", energyLevel == 0 && bandLevel[ENERGY_BAND_NUM - 1] == 0);
+
+  // Each key lights the band of its own LED (layout of KeyboardProfile.h, or LEDPianoTables.h with KEY_TABLES)
+  bool aligned = true;
+  bool inverted = true;
+  for (uint8_t k = 0; k < NUM_KEYS; ++k) {
+    aligned = aligned && getLedEnergyBand(getKeyLed(k)) == k / 12;
+    inverted = inverted && getLedKey(getKeyLed(k)) == k;
+  }
+  report("LED of each key maps back to the key", inverted);
+  report("energy bands follow the keys", aligned);
+}
+
+#ifdef PARTICLE_EFFECT
+static uint8_t getParticleNum() {
+  uint8_t particleNum = 0;
+  for (uint8_t p = 0; p < PARTICLE_POOL_SIZE; ++p) {
+    particleNum += particles[p].life != 0;
+  }
+  return particleNum;
+}
+
+static void clearParticles() {
+  for (uint8_t p = 0; p < PARTICLE_POOL_SIZE; ++p) {
+    particles[p].life = 0;
+  }
+}
+
+static void checkParticles() {
+  // Particles spawned on any key, including LEDs >= 128, live longer than one frame
+  const uint8_t keys[] = {0, NUM_KEYS / 2, NUM_KEYS - 1};
+  for (uint8_t animation = 10; animation <= 11; ++animation) {
+    keyAnimation = animation;
+    for (uint8_t k = 0; k < sizeof(keys); ++k) {
+      clearParticles();
+      spawnKeyParticles(keys[k], 0x7F, CRGB(0xFF, 0xFF, 0xFF));
+      uint8_t spawnedNum = getParticleNum();
+      updateParticles();
+      updateParticles();
+      char name[64];
+      snprintf(name, sizeof(name), "particles of animation %u on key %u survive 2 frames", animation, keys[k]);
+      report(name, spawnedNum > 0 && getParticleNum() > 0);
+    }
+  }
+  clearParticles();
+}
+#endif
+
+#ifdef PROFILE
+static void checkProfile() {
+  // Stage counters keep counting past 16 bits, a full total is halved with its count
+  ProfileStage& stage = profileStages[PROFILE_USB];
+  resetProfile();
+  stage.count = 0xFFFF;
+  recordProfile(PROFILE_USB, micros());
+  report("profile count passes 0xFFFF", stage.count == 0x10000);
+
+  stage.totalTime = 0xFFFFFFF0;
+  stage.count = 1000;
+  recordProfile(PROFILE_USB, micros() - 100);
+  report("full profile total is halved with its count",
+         stage.count == 501 && stage.totalTime >= 0x7FFFFFF8u + 100 && stage.totalTime < 0x80000000u + 200);
+  resetProfile();
+}
+#endif
+
+#ifdef REPLAY_MODE
+static void recordKeyTap(uint8_t keyIndex) {
+  uint8_t noteOn[4] = {0x09, 0x90, uint8_t(getKeyMidi(keyIndex) - MIDI_OFFSET), 0x40};
+  uint8_t noteOff[4] = {0x08, 0x80, noteOn[2], 0x00};
+  recordReplayNote(noteOn);
+  recordReplayNote(noteOff);
+}
+
+static void checkReplay() {
+  // Replayed notes on setting keys don't change the style
+  settingStatus = 0x10;
+  startRecording();
+  recordKeyTap(getSettingKey(1)); // next style
+  recordKeyTap(getSlotKey(1));
+  recordKeyTap(confirmKey);
+  uint8_t lastAnimation = bgAnimation;
+  uint8_t lastConfigNum = configNum;
+  startPlayback();
+  playReplay();
+  report("replay leaves setting mode", settingStatus == 0x00 && replayPosition == replayCount);
+  report("replayed setting keys don't change the style", bgAnimation == lastAnimation && configNum == lastConfigNum);
+  stopReplay();
+
+#ifdef REPLAY_AUTOPLAY
+  // The saved recording plays at boot when the USB host can't be initialized
+  saveReplay();
+  replayCount = 0;
+  setenv("LEDPIANO_MIDI_IN", "/nonexistent/LEDPianoCheck", 1);
+  setup();
+  uint32_t startTime = millis();
+  while (millis() - startTime < 200) {
+    loop();
+    delay(1);
+  }
+  report("autoplay runs without USB host", (systemStatus & 0xF0) == 0x40 && isReplayPlaying()
+         && ledTimer.state() == RUNNING && errorFlashTimer.state() != RUNNING);
+  stopReplay();
+  replayCount = 0;
+  saveReplay(); // no autoplay for the next setup()
+#endif
+}
+#endif
+
+#ifdef FAST_BOOT
+static void checkConfigChecksum() {
+  // A slot over the brightness limit is limited on load, even if its checksum matches
+  uint8_t config[CONFIG_SIZE] = {0x01, 0x87, 0xC2, 0x01, 0xB8, 0x01, 0x07, 0xAF, 0x09, 0xFF};
+  initConfigChecksum();
+  validateConfig(config);
+  config[2] |= 0x0F;
+  config[9] |= 0x0F;
+  writeConfig(0, config); // checksum of the data as written
+  bool checksumMatches = isConfigChecked(0, config);
+  readValidConfig(0, config);
+  report("brightness limit is checked for slots with a matching checksum", checksumMatches
+         && (config[2] & 0x0F) <= MAX_BRIGHTNESS_BG && (config[9] & 0x0F) <= MAX_BRIGHTNESS_FG);
+}
+
+static void checkBoot() {
+  // USB host error at boot, then a retry succeeds within BOOT_SEEK_TIME: the style runs again, no frozen flash
+  setenv("LEDPIANO_MIDI_IN", "/nonexistent/LEDPianoCheck", 1);
+  setup();
+  bool flashing = (systemStatus & 0xF0) == 0x40 && errorFlashTimer.state() == RUNNING;
+  setenv("LEDPIANO_MIDI_IN", "/dev/null", 1); // opens, no instrument
+  usbRetryTime = millis();
+  for (uint8_t i = 0; i < 10; ++i) {
+    loop();
+    delay(1);
+  }
+  report("style runs after USB host retry at boot", flashing && (systemStatus & 0xF0) == 0x20 && isBootSeeking()
+         && ledTimer.state() == RUNNING && errorFlashTimer.state() != RUNNING);
+}
+#endif
+
+#ifdef SYSEX_CONFIG
+static void receiveSysExMessage(const uint8_t message[], uint8_t size) {
+  // USB-MIDI packets as sent by toUsbMidiPackets() of /Misc/LEDPianoSysEx.py
+  for (uint8_t i = 0; i < size; i += 3) {
+    uint8_t chunkSize = size - i < 3 ? size - i : 3;
+    uint8_t packet[4] = {uint8_t(i + 3 >= size ? 0x04 + chunkSize : 0x04), 0, 0, 0};
+    memcpy(&packet[1], &message[i], chunkSize);
+    processSysEx(packet);
+  }
+}
+
+static void checkSysEx() {
+  // Messages encoded by LEDPianoSysEx.py (26 / 27 / 7 bytes: packets end with code index 0x06 / 0x07 / 0x05)
+  const uint8_t config[CONFIG_SIZE] = {0x01, 0x87, 0xC2, 0x01, 0xB8, 0x01, 0x07, 0xAF, 0x09, 0xFF};
+  const uint8_t setCurrent[] = {0xF0, 0x7D, 0x4C, 0x50, 0x01, 0x00, 0x01, 0x08, 0x07, 0x0C, 0x02, 0x00, 0x01,
+                                0x0B, 0x08, 0x00, 0x01, 0x00, 0x07, 0x0A, 0x0F, 0x00, 0x09, 0x0F, 0x0F, 0xF7};
+  const uint8_t setSlot[] = {0xF0, 0x7D, 0x4C, 0x50, 0x02, 0x01, 0x00, 0x01, 0x08, 0x07, 0x0C, 0x02, 0x00, 0x01,
+                             0x0B, 0x08, 0x00, 0x01, 0x00, 0x07, 0x0A, 0x0F, 0x00, 0x09, 0x0F, 0x0F, 0xF7};
+  const uint8_t selectSlot[] = {0xF0, 0x7D, 0x4C, 0x50, 0x04, 0x01, 0xF7};
+  uint8_t currentConfig[CONFIG_SIZE];
+
+  loadConfigCache();
+  configNum = 0;
+  bgAnimation = 0xFF;
+  receiveSysExMessage(setCurrent, sizeof(setCurrent));
+  getCurrentConfig(currentConfig);
+  report("SysEx set current style", memcmp(currentConfig, config, CONFIG_SIZE) == 0);
+
+  receiveSysExMessage(setSlot, sizeof(setSlot));
+  report("SysEx set slot", memcmp(configCache[1], config, CONFIG_SIZE) == 0);
+
+  bgAnimation = 0xFF;
+  receiveSysExMessage(selectSlot, sizeof(selectSlot));
+  getCurrentConfig(currentConfig);
+  report("SysEx select slot", configNum == 1 && memcmp(currentConfig, config, CONFIG_SIZE) == 0);
+
+  // One config too many: the message is dropped, the style is kept
+  uint8_t tooLong[sizeof(setCurrent) + 2 * CONFIG_SIZE];
+  memcpy(tooLong, setCurrent, sizeof(setCurrent) - 1);
+  memset(&tooLong[sizeof(setCurrent) - 1], 0x00, 2 * CONFIG_SIZE);
+  tooLong[sizeof(tooLong) - 1] = 0xF7;
+  receiveSysExMessage(tooLong, sizeof(tooLong));
+  getCurrentConfig(currentConfig);
+  report("SysEx drops a message with two configs", memcmp(currentConfig, config, CONFIG_SIZE) == 0);
+}
+#endif
+
+int main() {
+  checkEnergy();
+#ifdef PARTICLE_EFFECT
+  checkParticles();
+#endif
+#ifdef PROFILE
+  checkProfile();
+#endif
+#ifdef SYSEX_CONFIG
+  checkSysEx();
+#endif
+#ifdef REPLAY_MODE
+  checkReplay(); // calls setup() with REPLAY_AUTOPLAY
+#endif
+#ifdef FAST_BOOT
+  checkConfigChecksum();
+  checkBoot(); // calls setup()
+#endif
+  printf("%d check(s) failed\n", failedNum);
+  return failedNum;
+}
@@ -0,0 +1,180 @@
+/* LED Piano host build: runs the unmodified sketch on a computer (see Makefile)
+
+   Usage:
+     LEDPIANO_MIDI_IN=song.mid LEDPIANO_EEPROM=eeprom.bin ./build/LEDPianoHost
+       LEDPIANO_MIDI_IN: Standard MIDI File (*.mid), or raw 4-byte USB-MIDI packets from a file / FIFO (stdin if not set)
+       LEDPIANO_MIDI_LOOP=1: play the MIDI file over and over
+       LEDPIANO_EEPROM: saved styles (kept in memory if not set)
+       LEDPIANO_VIEW: ansi (default): the strip in the terminal (24-bit color, two LEDs per character) & statistics
+                      none: no terminal output, e.g. with LEDPIANO_PNG
+       LEDPIANO_PNG: directory for PNG snapshots of the strip (frame_000001.png ...)
+       LEDPIANO_PNG_INTERVAL: ms between PNG snapshots (default 1000, 0 = every shown frame)
+       LEDPIANO_SECONDS: quit after this many seconds (default: run until Ctrl+C)
+   Statistics (every second in the terminal view, summary on stderr at exit):
+     fps: frames shown per second, frame interval max (ms)
+     frame: time of the loop() that rendered & showed a frame, average / max (us)
+     latency: MIDI packet read -> first frame showing it, average / max (ms)
+   Serial output goes to stderr.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Arduino.h"
+#include "FastLED.h"
+#include "HostEmulator.h"
+
+void setup();
+void loop();
+
+struct HostStats {
+  uint32_t frameNum = 0;
+  uint32_t frameIntervalMax = 0; // us
+  uint64_t frameTimeTotal = 0; // us
+  uint32_t frameTimeMax = 0;
+  uint32_t inputNum = 0;
+  uint64_t latencyTotal = 0; // us
+  uint32_t latencyMax = 0;
+
+  void addLatency(uint32_t latency) {
+    ++inputNum;
+    latencyTotal += latency;
+    latencyMax = std::max(latencyMax, latency);
+  }
+
+  void addFrameTime(uint32_t frameTime) {
+    frameTimeTotal += frameTime;
+    frameTimeMax = std::max(frameTimeMax, frameTime);
+  }
+
+  std::string format(double seconds) const {
+    char text[160];
+    snprintf(text, sizeof(text), "fps %.1f (max interval %.1f ms) | frame avg %u us, max %u us | latency avg %.1f ms, max %.1f ms (%u)",
+             seconds > 0 ? frameNum / seconds : 0.0, frameIntervalMax / 1000.0,
+             frameNum ? unsigned(frameTimeTotal / frameNum) : 0u, unsigned(frameTimeMax),
+             inputNum ? latencyTotal / 1000.0 / inputNum : 0.0, latencyMax / 1000.0, unsigned(inputNum));
+    return text;
+  }
+};
+
+static bool ansiView = true;
+static const char* pngDirectory = NULL;
+static uint32_t pngInterval = 1000; // ms
+static uint32_t pngNum = 0;
+static uint32_t lastPngTime = 0;
+static std::vector<CRGB> shownStrip;
+static std::string statsLine;
+
+static HostStats totalStats;
+static HostStats secondStats;
+static uint32_t secondStart = 0; // micros()
+static uint32_t lastFrameTime = 0;
+static bool frameShown = false; // by the current loop()
+static std::atomic<bool> quitRequested(false);
+
+static void drawStrip(const CRGB strip[], uint16_t num) {
+  std::string line = "\r";
+  char cell[64];
+  for (uint16_t i = 0; i < num; i += 2) {
+    // left half block: LED i as foreground, LED i + 1 as background
+    CRGB right = i + 1 < num ? strip[i + 1] : CRGB();
+    snprintf(cell, sizeof(cell), "\x1b[38;2;%u;%u;%u;48;2;%u;%u;%um\xe2\x96\x8c",
+             strip[i].r, strip[i].g, strip[i].b, right.r, right.g, right.b);
+    line += cell;
+  }
+  line += "\x1b[0m\n\x1b[2K" + statsLine + "\x1b[1A\r"; // statistics on the next line, cursor back to the strip
+  fwrite(line.data(), 1, line.size(), stdout);
+  fflush(stdout);
+}
+
+static void savePng(const CRGB strip[], uint16_t num) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/frame_%06u.png", pngDirectory, unsigned(++pngNum));
+  if (!hostWritePng(path, strip, num, 4)) {
+    fprintf(stderr, "Cannot write %s\n", path);
+    pngDirectory = NULL;
+  }
+}
+
+void hostShowStrip(const CRGB strip[], uint16_t num, uint32_t inputTime) {
+  uint32_t now = micros();
+  frameShown = true;
+  for (HostStats* stats : {&totalStats, &secondStats}) {
+    ++stats->frameNum;
+    if (totalStats.frameNum > 1) {
+      stats->frameIntervalMax = std::max(stats->frameIntervalMax, now - lastFrameTime);
+    }
+    if (inputTime != HOST_NO_INPUT) {
+      stats->addLatency(now - inputTime);
+    }
+  }
+  lastFrameTime = now;
+
+  if (pngDirectory && (pngInterval == 0 || millis() - lastPngTime >= pngInterval || pngNum == 0)) {
+    lastPngTime = millis();
+    savePng(strip, num);
+  }
+
+  if (!ansiView || (shownStrip.size() == num && std::equal(shownStrip.begin(), shownStrip.end(), strip))) {
+    return; // unchanged
+  }
+  shownStrip.assign(strip, strip + num);
+  drawStrip(strip, num);
+}
+
+static void updateSecondStats(uint32_t now) {
+  if (now - secondStart < 1000000) {
+    return;
+  }
+  statsLine = secondStats.format((now - secondStart) / 1000000.0);
+  secondStats = HostStats();
+  secondStart = now;
+  if (ansiView && !shownStrip.empty()) {
+    drawStrip(shownStrip.data(), shownStrip.size());
+  }
+}
+
+static void requestQuit(int) {
+  quitRequested.store(true);
+}
+
+int main() {
+  const char* view = getenv("LEDPIANO_VIEW");
+  ansiView = !view || strcmp(view, "none") != 0;
+  pngDirectory = getenv("LEDPIANO_PNG");
+  if (getenv("LEDPIANO_PNG_INTERVAL")) {
+    pngInterval = strtoul(getenv("LEDPIANO_PNG_INTERVAL"), NULL, 10);
+  }
+  uint32_t runTime = getenv("LEDPIANO_SECONDS") ? strtoul(getenv("LEDPIANO_SECONDS"), NULL, 10) * 1000 : 0; // ms
+  signal(SIGINT, requestQuit);
+  signal(SIGTERM, requestQuit);
+
+  setup();
+  secondStart = micros();
+  uint32_t startTime = micros();
+  while (!quitRequested.load() && (runTime == 0 || millis() < runTime)) {
+    uint32_t loopStart = micros();
+    frameShown = false;
+    loop();
+    uint32_t now = micros();
+    if (frameShown) {
+      totalStats.addFrameTime(now - loopStart);
+      secondStats.addFrameTime(now - loopStart);
+    }
+    updateSecondStats(now);
+    std::this_thread::sleep_for(std::chrono::microseconds(100)); // loop() only polls, don't spin a whole core
+  }
+
+  if (ansiView) {
+    printf("\n\n");
+  }
+  fprintf(stderr, "%s\n", totalStats.format((micros() - startTime) / 1000000.0).c_str());
+  if (pngNum) {
+    fprintf(stderr, "%u PNG frames in %s\n", unsigned(pngNum), pngDirectory ? pngDirectory : "(stopped)");
+  }
+  return 0;
+}
@@ -0,0 +1,182 @@
+/* Standard MIDI File reader of the host build, see include/HostEmulator.h
+   Channel messages of all tracks are merged and timed by the tempo map, SysEx & meta events are skipped.
+*/
+
+#include <algorithm>
+#include "HostEmulator.h"
+
+struct MidiFileEvent {
+  uint32_t tick;
+  uint32_t tempo; // us per quarter note, 0 for channel messages
+  uint8_t packet[4];
+};
+
+class MidiFileReader {
+public:
+  MidiFileReader(const std::vector<uint8_t>& data, size_t start, size_t end) : data(data), position(start), end(end) {}
+
+  size_t getPosition() const { return position; }
+  bool atEnd() const { return position >= end; }
+  bool has(size_t size) const { return position + size <= end; }
+  uint8_t peek() const { return data[position]; }
+  uint8_t readByte() { return data[position++]; }
+  void skip(size_t size) { position += size; }
+
+  uint32_t readNumber(uint8_t size) { // big endian
+    uint32_t number = 0;
+    for (uint8_t i = 0; i < size; ++i) {
+      number = (number << 8) | readByte();
+    }
+    return number;
+  }
+
+  bool readVariableLength(uint32_t& number) {
+    number = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+      if (!has(1)) {
+        return false;
+      }
+      uint8_t value = readByte();
+      number = (number << 7) | (value & 0x7F);
+      if ((value & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  const std::vector<uint8_t>& data;
+  size_t position;
+  size_t end;
+};
+
+static bool readTrack(MidiFileReader track, std::vector<MidiFileEvent>& events) {
+  uint32_t tick = 0;
+  uint8_t runningStatus = 0;
+  while (!track.atEnd()) {
+    uint32_t delta;
+    if (!track.readVariableLength(delta) || !track.has(1)) {
+      return false;
+    }
+    tick += delta;
+    uint8_t status = track.peek();
+    if (status & 0x80) {
+      track.skip(1);
+    } else if (runningStatus) {
+      status = runningStatus; // running status: data byte follows
+    } else {
+      return false;
+    }
+
+    if (status == 0xFF) { // meta event
+      uint32_t length;
+      if (!track.has(1)) {
+        return false;
+      }
+      uint8_t type = track.readByte();
+      if (!track.readVariableLength(length) || !track.has(length)) {
+        return false;
+      }
+      if (type == 0x51 && length == 3) { // set tempo
+        MidiFileEvent event = {tick, track.readNumber(3), {0, 0, 0, 0}};
+        events.push_back(event);
+      } else {
+        track.skip(length);
+      }
+    } else if (status == 0xF0 || status == 0xF7) { // SysEx
+      uint32_t length;
+      if (!track.readVariableLength(length) || !track.has(length)) {
+        return false;
+      }
+      track.skip(length);
+      runningStatus = 0;
+    } else if (status >= 0x80 && status < 0xF0) { // channel message
+      uint8_t dataSize = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 1 : 2;
+      if (!track.has(dataSize)) {
+        return false;
+      }
+      MidiFileEvent event = {tick, 0, {uint8_t(status >> 4), status, 0, 0}}; // code index number = status >> 4
+      event.packet[2] = track.readByte() & 0x7F;
+      if (dataSize == 2) {
+        event.packet[3] = track.readByte() & 0x7F;
+      }
+      events.push_back(event);
+      runningStatus = status;
+    } else {
+      return false; // system common messages are not allowed in files
+    }
+  }
+  return true;
+}
+
+bool hostLoadMidiFile(const char* path, std::vector<HostMidiEvent>& events) {
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + size);
+  }
+  fclose(file);
+
+  MidiFileReader header(data, 0, data.size());
+  if (!header.has(14) || memcmp(&data[0], "MThd", 4) != 0) {
+    return false;
+  }
+  header.skip(4);
+  uint32_t headerLength = header.readNumber(4);
+  header.readNumber(2); // format 0 / 1 are both merged, format 2 is played as format 1
+  uint16_t trackNum = header.readNumber(2);
+  uint16_t division = header.readNumber(2);
+  if (headerLength < 6 || !header.has(headerLength - 6) || (division & 0x7FFF) == 0 || (division & 0x80FF) == 0x8000) {
+    return false;
+  }
+  header.skip(headerLength - 6);
+
+  std::vector<MidiFileEvent> fileEvents;
+  uint16_t trackCount = 0;
+  while (trackCount < trackNum && header.has(8)) {
+    bool isTrack = header.readNumber(4) == 0x4D54726B; // "MTrk", other chunks are skipped
+    uint32_t trackLength = header.readNumber(4);
+    if (!header.has(trackLength)) {
+      return false;
+    }
+    if (isTrack) {
+      if (!readTrack(MidiFileReader(data, header.getPosition(), header.getPosition() + trackLength), fileEvents)) {
+        return false;
+      }
+      ++trackCount;
+    }
+    header.skip(trackLength);
+  }
+  std::stable_sort(fileEvents.begin(), fileEvents.end(), [](const MidiFileEvent& a, const MidiFileEvent& b) {
+    return a.tick < b.tick; // tracks are merged, tempo changes of track 0 come first on the same tick
+  });
+
+  // ticks -> us by the tempo map
+  bool isSmpte = (division & 0x8000) != 0; // SMPTE: frames per second (negative) & ticks per frame, no tempo
+  double tickTime = isSmpte ? 1000000.0 / (double(-int8_t(division >> 8)) * double(division & 0xFF))
+                    : 500000.0 / division; // us per tick, 120 BPM until the first tempo event
+  double time = 0.0;
+  uint32_t lastTick = 0;
+  events.clear();
+  for (const MidiFileEvent& event : fileEvents) {
+    time += double(event.tick - lastTick) * tickTime;
+    lastTick = event.tick;
+    if (event.tempo) {
+      if (!isSmpte) {
+        tickTime = double(event.tempo) / division;
+      }
+      continue;
+    }
+    HostMidiEvent hostEvent;
+    hostEvent.time = uint32_t(time + 0.5);
+    memcpy(hostEvent.packet, event.packet, 4);
+    events.push_back(hostEvent);
+  }
+  return true;
+}
@@ -0,0 +1,92 @@
+/* PNG output of the host build, see include/HostEmulator.h
+   No zlib needed: image data is written as stored (uncompressed) deflate blocks.
+*/
+
+#include <algorithm>
+#include <vector>
+#include "HostEmulator.h"
+
+static uint32_t getCrc32(const uint8_t data[], size_t size, uint32_t crc = 0) {
+  static uint32_t table[256];
+  if (table[1] == 0) {
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (uint8_t k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+      }
+      table[n] = c;
+    }
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+static void appendNumber(std::vector<uint8_t>& out, uint32_t number) { // big endian
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    out.push_back(uint8_t(number >> shift));
+  }
+}
+
+static void appendChunk(std::vector<uint8_t>& out, const char type[], const std::vector<uint8_t>& data) {
+  appendNumber(out, data.size());
+  size_t typeStart = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  appendNumber(out, getCrc32(&out[typeStart], out.size() - typeStart));
+}
+
+bool hostWritePng(const char* path, const CRGB strip[], uint16_t num, uint8_t scale) {
+  const uint32_t width = uint32_t(num) * scale;
+  const uint32_t height = uint32_t(scale) * 4;
+  const size_t rowSize = 1 + width * 3; // filter byte + RGB
+
+  std::vector<uint8_t> row(rowSize, 0); // filter 0: none
+  for (uint32_t x = 0; x < width; ++x) {
+    const CRGB& led = strip[x / scale];
+    row[1 + x * 3] = led.r;
+    row[2 + x * 3] = led.g;
+    row[3 + x * 3] = led.b;
+  }
+  std::vector<uint8_t> raw;
+  for (uint32_t y = 0; y < height; ++y) {
+    raw.insert(raw.end(), row.begin(), row.end()); // LEDs are the same on every row
+  }
+
+  // zlib stream of stored blocks (max 65535 bytes each)
+  std::vector<uint8_t> zlib = {0x78, 0x01};
+  for (size_t start = 0; start < raw.size() || start == 0; start += 0xFFFF) {
+    size_t size = std::min<size_t>(0xFFFF, raw.size() - start);
+    zlib.push_back(start + size >= raw.size() ? 1 : 0); // final block?
+    zlib.push_back(uint8_t(size));
+    zlib.push_back(uint8_t(size >> 8));
+    zlib.push_back(uint8_t(~size));
+    zlib.push_back(uint8_t(~size >> 8));
+    zlib.insert(zlib.end(), raw.begin() + start, raw.begin() + start + size);
+  }
+  uint32_t a = 1, b = 0; // Adler-32
+  for (uint8_t value : raw) {
+    a = (a + value) % 65521;
+    b = (b + a) % 65521;
+  }
+  appendNumber(zlib, (b << 16) | a);
+
+  std::vector<uint8_t> header;
+  appendNumber(header, width);
+  appendNumber(header, height);
+  header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, deflate, no filter, no interlace
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  appendChunk(png, "IHDR", header);
+  appendChunk(png, "IDAT", zlib);
+  appendChunk(png, "IEND", std::vector<uint8_t>());
+
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+  bool written = fwrite(png.data(), 1, png.size(), file) == png.size();
+  return fclose(file) == 0 && written;
+}
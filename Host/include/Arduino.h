@@ -0,0 +1,57 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*
+   Minimal Arduino core for the host build (LEDPIANO_HOST), only what the sketch uses
+   Serial prints to stderr, so stdout is left for the LED strip output.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "avr/pgmspace.h"
+
+#define DEC 10
+#define HEX 16
+#define F(s) (s)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+class HostSerial {
+public:
+  void begin(unsigned long) {}
+  operator bool() { return true; }
+  int available() { return 0; }
+  int read() { return -1; }
+  int availableForWrite() { return 64; }
+  size_t write(uint8_t data);
+  size_t write(const uint8_t data[], size_t size);
+
+  size_t print(const char text[]);
+  size_t print(char c);
+  size_t print(unsigned char number, int base = DEC) { return print((unsigned long)number, base); }
+  size_t print(int number, int base = DEC) { return print((long)number, base); }
+  size_t print(unsigned int number, int base = DEC) { return print((unsigned long)number, base); }
+  size_t print(long number, int base = DEC);
+  size_t print(unsigned long number, int base = DEC);
+  size_t print(double number, int digits = 2);
+
+  size_t println() { return print("\r\n"); }
+  template <typename T> size_t println(T value) { return print(value) + println(); }
+  template <typename T> size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+extern HostSerial Serial;
+
+#endif
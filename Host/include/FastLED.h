@@ -0,0 +1,98 @@
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+/*
+   Minimal FastLED for the host build (LEDPIANO_HOST), only what the sketch uses
+   hsv2rgb_rainbow() follows FastLED (FASTLED_SCALE8_FIXED = 1), so colors match the strip.
+*/
+
+#include "Arduino.h"
+
+struct CHSV {
+  union {
+    struct {
+      uint8_t hue;
+      uint8_t sat;
+      uint8_t val;
+    };
+    struct {
+      uint8_t h;
+      uint8_t s;
+      uint8_t v;
+    };
+    uint8_t raw[3];
+  };
+
+  CHSV() : hue(0), sat(0), val(0) {}
+  CHSV(uint8_t ih, uint8_t is, uint8_t iv) : hue(ih), sat(is), val(iv) {}
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb);
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) {
+  return (uint16_t(i) * (1 + uint16_t(scale))) >> 8;
+}
+
+inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+  return ((uint16_t(i) * scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+  uint16_t t = i + j;
+  return t > 255 ? 255 : t;
+}
+
+struct CRGB {
+  union {
+    struct {
+      uint8_t r;
+      uint8_t g;
+      uint8_t b;
+    };
+    uint8_t raw[3];
+  };
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(const CHSV& hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+  CRGB& operator=(const CHSV& hsv) {
+    hsv2rgb_rainbow(hsv, *this);
+    return *this;
+  }
+
+  CRGB& operator+=(const CRGB& rhs) {
+    r = qadd8(r, rhs.r);
+    g = qadd8(g, rhs.g);
+    b = qadd8(b, rhs.b);
+    return *this;
+  }
+
+  CRGB& nscale8(uint8_t scale) {
+    r = scale8(r, scale);
+    g = scale8(g, scale);
+    b = scale8(b, scale);
+    return *this;
+  }
+
+  uint8_t& operator[](uint8_t x) { return raw[x]; }
+  const uint8_t& operator[](uint8_t x) const { return raw[x]; }
+  bool operator==(const CRGB& rhs) const { return r == rhs.r && g == rhs.g && b == rhs.b; }
+  bool operator!=(const CRGB& rhs) const { return !(*this == rhs); }
+};
+
+template <int SIZE>
+class CRGBArray {
+public:
+  CRGB& operator[](int x) { return entries[x]; }
+  const CRGB& operator[](int x) const { return entries[x]; }
+  operator CRGB*() { return entries; }
+  operator const CRGB*() const { return entries; }
+  int size() const { return SIZE; }
+
+private:
+  CRGB entries[SIZE];
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HOST_EMULATOR_H
+#define HOST_EMULATOR_H
+
+/*
+   Emulator functions of the host build shared by the sketch backend (PlatformHost.h) and the Host*.cpp files
+*/
+
+#include <stdint.h>
+#include <vector>
+#include "FastLED.h"
+
+struct HostMidiEvent {
+  uint32_t time; // us from the start of the file
+  uint8_t packet[4]; // USB-MIDI packet
+};
+
+// HostMidiFile.cpp: Standard MIDI File (format 0 / 1) -> time-ordered channel messages, false if not readable
+bool hostLoadMidiFile(const char* path, std::vector<HostMidiEvent>& events);
+
+#define HOST_NO_INPUT 0xFFFFFFFF
+
+// HostMain.cpp: a frame of the strip is shown,
+// inputTime: micros() when the oldest MIDI packet first shown by this frame was read, HOST_NO_INPUT if none
+void hostShowStrip(const CRGB strip[], uint16_t num, uint32_t inputTime);
+
+// HostPng.cpp: the strip as a PNG image, each LED is scale x (4 * scale) pixels
+bool hostWritePng(const char* path, const CRGB strip[], uint16_t num, uint8_t scale);
+
+#endif
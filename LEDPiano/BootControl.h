@@ -0,0 +1,52 @@
+#ifndef BOOT_CONTROL_H
+#define BOOT_CONTROL_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   Fast boot (FAST_BOOT in LEDPianoConfig.h)
+   setup() loads the saved style (see checksums in ConfigStorage.h) and shows its first frame,
+   then initializes the USB host. While the instrument enumerates, the style is rendered instead of the MIDI warning flash,
+   until BOOT_SEEK_TIME or the first connection. Times are ms from the start of the sketch (bootloader not included).
+*/
+#ifdef FAST_BOOT
+
+uint32_t firstFrameTime = 0;
+uint32_t midiHostReadyTime = 0; // USB host initialized
+uint32_t midiConnectTime = 0; // 0: no instrument since boot
+
+void recordFirstFrame() {
+  firstFrameTime = millis();
+}
+
+void recordMidiHostReady() {
+  midiHostReadyTime = millis();
+}
+
+void recordMidiConnect() {
+  if (midiConnectTime == 0) {
+    midiConnectTime = millis() | 1; // not 0
+  }
+}
+
+bool isBootSeeking() {
+  // Still waiting for the first instrument after boot
+  return midiConnectTime == 0 && millis() < BOOT_SEEK_TIME;
+}
+
+void printBootTimes() {
+  Serial.print(F("Boot (ms): first frame "));
+  Serial.print(firstFrameTime);
+  Serial.print(F(", USB host "));
+  Serial.print(midiHostReadyTime);
+  Serial.print(F(", MIDI "));
+  if (midiConnectTime) {
+    Serial.println(midiConnectTime);
+  } else {
+    Serial.println(F("not connected"));
+  }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef CAPTURE_CONTROL_H
+#define CAPTURE_CONTROL_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   Frame capture via serial (decoder: /Misc/LEDFrameCapture.py)
+   Each shown frame is sent as one record:
+     0xA5 0x5A | type | timestamp (millis, 4 bytes, little endian) | NUM_LEDS | payload | checksum
+   type 0x01: full frame, payload = RLE runs of [count(1 - 255), R, G, B] covering NUM_LEDS LEDs
+   type 0x02: same as previous frame, no payload
+   checksum: low byte of the sum of all bytes from type to the end of payload
+   Repeats are detected by a 32-bit hash (no SRAM for a copy of the frame), a full frame is still sent
+   after CAPTURE_KEYFRAME_INTERVAL repeats, so a hash collision can't hide a change for longer than that.
+*/
+#ifdef FRAME_CAPTURE
+
+uint32_t lastCaptureHash = 0;
+bool hasCapturedFrame = false;
+uint8_t captureRepeatCount = 0; // repeat records since the last full frame
+uint8_t captureFrameCount = 0;
+uint8_t captureChecksum = 0;
+
+void captureWrite(uint8_t data) {
+  Serial.write(data);
+  captureChecksum += data;
+}
+
+uint32_t getFrameHash() {
+  // Fletcher style sums of the whole frame (mod 65536), any single changed byte changes the hash
+  uint16_t sum1 = 0;
+  uint16_t sum2 = 0;
+  for (int j = 0; j < NUM_LEDS; ++j) {
+    sum1 += leds[j].r; sum2 += sum1;
+    sum1 += leds[j].g; sum2 += sum1;
+    sum1 += leds[j].b; sum2 += sum1;
+  }
+  return (uint32_t(sum2) << 16) | sum1;
+}
+
+void captureFrame() {
+  if (++captureFrameCount < CAPTURE_FRAME_DIVIDER) {
+    return;
+  }
+  captureFrameCount = 0;
+
+  uint32_t frameHash = getFrameHash();
+  bool repeated = hasCapturedFrame && (frameHash == lastCaptureHash) && captureRepeatCount < CAPTURE_KEYFRAME_INTERVAL;
+  captureRepeatCount = repeated ? captureRepeatCount + 1 : 0;
+  lastCaptureHash = frameHash;
+  hasCapturedFrame = true;
+
+  uint32_t timestamp = millis();
+  Serial.write(0xA5);
+  Serial.write(0x5A);
+  captureChecksum = 0;
+  captureWrite(repeated ? 0x02 : 0x01);
+  captureWrite(timestamp & 0xFF);
+  captureWrite((timestamp >> 8) & 0xFF);
+  captureWrite((timestamp >> 16) & 0xFF);
+  captureWrite((timestamp >> 24) & 0xFF);
+  captureWrite(NUM_LEDS);
+  if (!repeated) {
+    int j = 0;
+    while (j < NUM_LEDS) {
+      uint8_t runLength = 1;
+      while (j + runLength < NUM_LEDS && runLength < 0xFF && leds[j + runLength] == leds[j]) {
+        ++runLength;
+      }
+      captureWrite(runLength);
+      captureWrite(leds[j].r);
+      captureWrite(leds[j].g);
+      captureWrite(leds[j].b);
+      j += runLength;
+    }
+  }
+  Serial.write(captureChecksum);
+}
+
+#endif
+
+#endif
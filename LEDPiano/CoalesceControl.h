@@ -0,0 +1,69 @@
+#ifndef COALESCE_CONTROL_H
+#define COALESCE_CONTROL_H
+
+#include "ProfileControl.h"
+
+/*
+   MIDI event coalescing (MIDI_COALESCE in LEDPianoConfig.h)
+   Note on / off events of keyData[] keys are merged per key until the next frame is rendered:
+     several note on: the key is activated once with the highest velocity (one random color, one particle burst)
+     note on then off: the key is activated and released on the same frame, still flashes (tap)
+     last event off: the key is released
+   When COALESCE_SIZE keys have pending events, they are applied before a new key is added,
+   so per-frame work is bounded by the number of distinct keys, not by the number of MIDI events.
+   Note energy, statistics and replay recording still count every note on.
+*/
+#ifdef MIDI_COALESCE
+
+#define COALESCE_PRESSED 0x01 // note on since the last frame
+#define COALESCE_RELEASED 0x02 // last event is note off
+
+struct CoalescedNote {
+  uint8_t keyIndex;
+  uint8_t velocity; // highest note on velocity
+  uint8_t flags;
+};
+
+CoalescedNote coalescedNotes[COALESCE_SIZE];
+uint8_t coalescedNoteNum = 0;
+
+bool isCoalesceFull() {
+  return coalescedNoteNum >= COALESCE_SIZE;
+}
+
+bool coalesceNote(uint8_t keyIndex, uint8_t velocity) {
+  // velocity = 0 for note off, false if a new key is needed but the list is full
+  for (uint8_t n = 0; n < coalescedNoteNum; ++n) {
+    CoalescedNote& pending = coalescedNotes[n];
+    if (pending.keyIndex == keyIndex) {
+      if (velocity > 0) {
+        pending.flags = (pending.flags | COALESCE_PRESSED) & ~COALESCE_RELEASED;
+        if (velocity > pending.velocity) {
+          pending.velocity = velocity;
+        }
+      } else {
+        pending.flags |= COALESCE_RELEASED;
+      }
+#ifdef PROFILE
+      ++coalescedEventCount;
+#endif
+      return true;
+    }
+  }
+  if (isCoalesceFull()) {
+    return false;
+  }
+  CoalescedNote& pending = coalescedNotes[coalescedNoteNum++];
+  pending.keyIndex = keyIndex;
+  pending.velocity = velocity;
+  pending.flags = velocity > 0 ? COALESCE_PRESSED : COALESCE_RELEASED;
+  return true;
+}
+
+void clearCoalescedNotes() {
+  coalescedNoteNum = 0;
+}
+
+#endif
+
+#endif
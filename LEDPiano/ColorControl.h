@@ -2,35 +2,48 @@
 #define COLOR_CONTROL_H
 
 #include "KeyControl.h"
+#include "EnergyControl.h"
+#include "StatsControl.h"
+
+uint16_t getAlphaWeight(uint8_t alpha) {
+  // Alpha (0 - MAX_ALPHA) -> 16-bit linear blending weight
+  // Brightness codes are not corrected: hsv2rgb_rainbow() already squares val (about gamma 2)
+#ifdef GAMMA_CORRECTION
+  return pgm_read_word(&gammaTable[alpha]);
+#else
+  return uint16_t(alpha) * 257;
+#endif
+}
+
+uint16_t getHuePosition(int hueCount, int huePeriod) {
+  // hueCount % huePeriod, negative counts wrap around (slow left to right rainbow counts below 0)
+  int huePosition = hueCount % huePeriod;
+  return huePosition < 0 ? huePosition + huePeriod : huePosition;
+}
+
+uint8_t getRainbowHue(uint16_t huePosition, uint16_t huePeriod) {
+  // huePosition (0 - huePeriod - 1) / huePeriod * 255, rounded, integer only
+  return (uint32_t(huePosition) * 510 + huePeriod) / (uint32_t(huePeriod) << 1);
+}
+
+uint8_t getGradientHue(uint16_t huePosition, uint16_t huePeriod, uint8_t startHue, uint8_t stopHue) {
+  // startHue -> stopHue in the first half of the period, then back (ping-pong), rounded, integer only
+  uint16_t swing = (huePosition << 1) <= huePeriod ? (huePosition << 1) : ((huePeriod - huePosition) << 1); // 0 - huePeriod
+  int32_t numerator = int32_t(startHue) * (huePeriod << 1) + int32_t(swing) * ((int16_t(stopHue) - startHue) << 1) + huePeriod;
+  return numerator / (uint32_t(huePeriod) << 1); // numerator >= 0
+}
 
 CRGB getRainbowColor(int hueCount, int huePeriod, uint8_t sat, uint8_t bri) {
-  float hueRatio = float(hueCount % huePeriod) / float(huePeriod);
-  uint8_t hue = uint8_t(hueRatio * 255.0 + 0.5);
-  return CHSV(hue, sat, bri);
+  return CHSV(getRainbowHue(getHuePosition(hueCount, huePeriod), huePeriod), sat, bri);
 }
 
 CRGB getGradientColor(int hueCount, int huePeriod, uint8_t startHue, uint8_t stopHue, uint8_t sat, uint8_t bri) {
-  float hueRatio = float(hueCount % huePeriod) / float(huePeriod);
-  if (hueRatio <= 0.5) {
-    hueRatio = hueRatio / 0.5;
-  } else {
-    hueRatio = (1.0 - hueRatio) / 0.5;
-  }
-  uint8_t hue = uint8_t(float(startHue) + hueRatio * (stopHue - startHue) + 0.5);
-  return CHSV(hue, sat, bri);
+  return CHSV(getGradientHue(getHuePosition(hueCount, huePeriod), huePeriod, startHue, stopHue), sat, bri);
 }
 
 CRGB getColorByCode(uint8_t colorCode, int hueCount, int huePeriod, uint8_t sat, uint8_t bri) {
   // Notice: Remember to add your new color code to bgColorList[] and keyColorList[]
-  const static uint8_t red = 0;
-  const static uint8_t orange = 20;
-  const static uint8_t yellow = 45;
-  const static uint8_t yellowGreen = 70;
-  const static uint8_t green = 92;
-  const static uint8_t cyan = 120;
-  const static uint8_t blue = 154;
-  const static uint8_t purple = 176;
-  const static uint8_t magenta = 224;
+  // Hue of each color: paletteHueList[] & gradientHueList[] in LEDPianoTables.h
 
   bool isGradient = (colorCode & 0x80) != 0;
   if (isGradient) {
@@ -43,17 +56,12 @@ CRGB getColorByCode(uint8_t colorCode, int hueCount, int huePeriod, uint8_t sat,
     uint8_t periodScalar = (colorCode & 0x60) >> 5; // totally 4 scalars
     hueCount *= (periodScalar + 1);
     uint8_t subcode = colorCode & 0x1F;
-    switch (subcode) {
-      case 0: return getRainbowColor(hueCount, huePeriod, sat, bri);
-      case 1: return getGradientColor(hueCount, huePeriod, red, yellow, sat, bri);
-      case 2: return getGradientColor(hueCount, huePeriod, yellow, green, sat, bri);
-      case 3: return getGradientColor(hueCount, huePeriod, green, blue, sat, bri);
-      case 4: return getGradientColor(hueCount, huePeriod, blue, magenta, sat, bri);
-      case 5: return getGradientColor(hueCount, huePeriod, red, green, sat, bri);
-      case 6: return getGradientColor(hueCount, huePeriod, yellow, blue, sat, bri);
-      case 7: return getGradientColor(hueCount, huePeriod, green, magenta, sat, bri);
-      default: return getRainbowColor(hueCount, huePeriod, sat, bri);
+    if (subcode == 0 || subcode >= GRADIENT_HUE_NUM) {
+      return getRainbowColor(hueCount, huePeriod, sat, bri);
     }
+    uint8_t startHue = pgm_read_byte(&gradientHueList[subcode][0]);
+    uint8_t stopHue = pgm_read_byte(&gradientHueList[subcode][1]);
+    return getGradientColor(hueCount, huePeriod, startHue, stopHue, sat, bri);
   } else {
     /*
        Pure color struct
@@ -65,32 +73,105 @@ CRGB getColorByCode(uint8_t colorCode, int hueCount, int huePeriod, uint8_t sat,
     switch (subcode) {
       case 0: return CHSV(0, 0, 0); // turn off
       case 1: return CHSV(0, 0, bri); // white / gray
-      case 2: return CHSV(red, sat, bri);
-      case 3: return CHSV(orange, sat, bri);
-      case 4: return CHSV(yellow, sat, bri);
-      case 5: return CHSV(yellowGreen, sat, bri);
-      case 6: return CHSV(green, sat, bri);
-      case 7: return CHSV(cyan, sat, bri);
-      case 8: return CHSV(blue, sat, bri);
-      case 9: return CHSV(purple, sat, bri);
-      case 10: return CHSV(magenta, sat, bri);
-      default: return CHSV(0, 0, 0); // turn off
+      default:
+        if (subcode < PALETTE_HUE_NUM) {
+          return CHSV(pgm_read_byte(&paletteHueList[subcode]), sat, bri);
+        }
+        return CHSV(0, 0, 0); // turn off
     }
   }
 
 }
 
-CRGB getKeyColor(KeyData& currentKey, int hueCount, uint8_t midiNum) {
+inline void writeLed(CRGB& led, const CRGB& color, uint16_t mix) {
+  // mix = 0: write, 1 - 256: blend with weight mix / 256
+  if (mix == 0) {
+    led = color;
+  } else {
+    for (uint8_t c = 0; c < 3; ++c) {
+      led[c] = uint8_t((led[c] * (256 - mix) + color[c] * mix) >> 8);
+    }
+  }
+}
+
+void fillColorSpan(CRGB span[], uint8_t count, uint8_t colorCode, int hueCount, uint8_t hueStep, int huePeriod,
+                   uint8_t sat, uint8_t bri, uint16_t mix) {
+  // Same as getColorByCode(colorCode, hueCount + i * hueStep, ...) for span[i], but
+  // pure colors (or hueStep = 0) are converted to RGB only once,
+  // gradient hue is stepped by integer addition, divided only at the start, turning point and end of the period.
+  bool isGradient = (colorCode & 0x80) != 0;
+  if (!isGradient || hueStep == 0) {
+    CRGB color = getColorByCode(colorCode, hueCount, huePeriod, sat, bri);
+    for (uint8_t i = 0; i < count; ++i) {
+      writeLed(span[i], color, mix);
+    }
+    return;
+  }
+
+  uint8_t periodScalar = ((colorCode & 0x60) >> 5) + 1;
+  uint8_t subcode = colorCode & 0x1F;
+  bool isRainbow = subcode == 0 || subcode >= GRADIENT_HUE_NUM;
+  uint8_t startHue = isRainbow ? 0 : pgm_read_byte(&gradientHueList[subcode][0]);
+  uint8_t stopHue = isRainbow ? 0 : pgm_read_byte(&gradientHueList[subcode][1]);
+  uint16_t period = huePeriod;
+  uint16_t position = getHuePosition(hueCount * periodScalar, huePeriod);
+  uint16_t step = (uint16_t(hueStep) * periodScalar) % huePeriod;
+
+  // hue = numerator / denominator, kept as quotient (hue) & remainder, numerator changes by a fixed delta per step
+  uint16_t denominator = period << 1;
+  int32_t delta = isRainbow ? int32_t(step) * 510 : int32_t(step) * ((int16_t(stopHue) - startHue) << 2);
+  int16_t deltaUp = delta / denominator; // rising half, floor
+  uint16_t deltaUpRemainder = delta - int32_t(deltaUp) * denominator;
+  if (delta < 0 && deltaUpRemainder != 0) {
+    --deltaUp;
+    deltaUpRemainder = delta - int32_t(deltaUp) * denominator;
+  }
+  int16_t deltaDown = -deltaUp - (deltaUpRemainder ? 1 : 0); // falling half of gradient: -delta
+  uint16_t deltaDownRemainder = deltaUpRemainder ? denominator - deltaUpRemainder : 0;
+
+  int16_t hue = 0;
+  uint16_t remainder = 0;
+  bool needDivide = true;
+  for (uint8_t i = 0; i < count; ++i) {
+    bool rising = isRainbow || (position << 1) <= period;
+    if (needDivide) {
+      hue = isRainbow ? getRainbowHue(position, period) : getGradientHue(position, period, startHue, stopHue);
+      uint16_t swing = rising ? (position << 1) : ((period - position) << 1);
+      int32_t numerator = isRainbow ? int32_t(position) * 510 + period
+                          : int32_t(startHue) * denominator + int32_t(swing) * ((int16_t(stopHue) - startHue) << 1) + period;
+      remainder = numerator - int32_t(hue) * denominator;
+      needDivide = false;
+    }
+    writeLed(span[i], CHSV(uint8_t(hue), sat, bri), mix);
+
+    position += step;
+    if (position >= period) { // next period
+      position -= period;
+      needDivide = true;
+    } else if (rising && !isRainbow && (position << 1) > period) { // turning point of gradient
+      needDivide = true;
+    } else {
+      hue += rising ? deltaUp : deltaDown;
+      remainder += rising ? deltaUpRemainder : deltaDownRemainder;
+      if (remainder >= denominator) {
+        remainder -= denominator;
+        ++hue;
+      }
+    }
+  }
+}
+
+CRGB getKeyColorBy(KeyData& currentKey, int hueCount, uint8_t midiNum, uint8_t whiteColor, uint8_t whiteSV, uint8_t blackColor, uint8_t blackSV) {
   uint8_t note = midiNum % 12;
   uint8_t keyColor;
   uint8_t keySV;
   bool isBlackKey = (currentKey.control & 0x80) != 0;
   if (isBlackKey) {
-    keyColor = blackKeyColor;
-    keySV = blackKeySV;
+    keyColor = blackColor;
+    keySV = blackSV;
   } else {
-    keyColor = whiteKeyColor;
-    keySV = whiteKeySV;
+    keyColor = whiteColor;
+    keySV = whiteSV;
   }
 
   uint8_t keySaturation = (keySV & 0xF0) | keySOffset;
@@ -118,13 +199,48 @@ CRGB getKeyColor(KeyData& currentKey, int hueCount, uint8_t midiNum) {
   }
 }
 
-void blendBgColors() {
-  uint8_t idleSaturation = (bgSVIdle & 0xF0) | bgSIdleOffset;
-  uint8_t idleBrightness = ((bgSVIdle & 0x0F) << 4) | bgVIdleOffset;
-  uint8_t activatedSaturation = (bgSVActivated & 0xF0) | bgSActivatedOffset;
-  uint8_t activatedBrightness = ((bgSVActivated & 0x0F) << 4) | bgVActivatedOffset;
+CRGB getKeyColor(KeyData& currentKey, int hueCount, uint8_t midiNum) {
+  return getKeyColorBy(currentKey, hueCount, midiNum, whiteKeyColor, whiteKeySV, blackKeyColor, blackKeySV);
+}
 
-  float powerRatio = getPowerRatio();
+struct BgStyle {
+  uint8_t animation; // bgAnimation
+  uint8_t colorIdle; // bgColorIdle
+  uint8_t svIdle; // bgSVIdle
+  uint8_t colorActivated; // bgColorActivated
+  uint8_t svActivated; // bgSVActivated
+  int16_t frameCount;
+};
+
+bool isBgLedActivated(uint8_t animation, int j, uint8_t activatedLedNum, uint8_t leftActivatedNum, uint8_t rightActivatedNum) {
+  switch (animation) {
+    case 0x10: // jump from left
+      return j < activatedLedNum;
+    case 0x11: // jump from right
+      return j > NUM_LEDS - 1 - activatedLedNum;
+    case 0x12: // jump from both sides
+      return j < leftActivatedNum || j > (NUM_LEDS - rightActivatedNum);
+    case 0x13: // jump from middle
+    case 0x31: // jump from middle with playing energy
+      return j > NUM_LEDS / 2 - leftActivatedNum && j < NUM_LEDS / 2 + rightActivatedNum;
+    default:
+      return false;
+  }
+}
+
+void renderBgStyle(BgStyle& style, uint16_t mix) {
+  // mix = 0: write leds[], 1 - 256: blend into leds[] with weight mix / 256
+  uint8_t idleSaturation = (style.svIdle & 0xF0) | bgSIdleOffset;
+  uint8_t idleBrightness = ((style.svIdle & 0x0F) << 4) | bgVIdleOffset;
+  uint8_t activatedSaturation = (style.svActivated & 0xF0) | bgSActivatedOffset;
+  uint8_t activatedBrightness = ((style.svActivated & 0x0F) << 4) | bgVActivatedOffset;
+
+  float powerRatio = 0.0;
+  if ((style.animation & 0xF0) == 0x10) {
+    powerRatio = getPowerRatio();
+  } else if ((style.animation & 0xF0) == 0x30) {
+    powerRatio = float(getEnergyRatio()) / 255.0;
+  }
   uint8_t activatedLedNum = uint8_t(powerRatio * NUM_LEDS + 0.5);
 
   const static uint8_t leftLedNum = NUM_LEDS / 2;
@@ -135,35 +251,34 @@ void blendBgColors() {
   const static int timeScalar = 5;
 
   int huePeriod = NUM_LEDS;
-  int hueCount = 0;
 
   // Notice: Remember to add your new code to bgAnimationList[]
-  switch (bgAnimation) { // set hue period
+  switch (style.animation) { // set hue period
     case 0x20: // dynamic rainbow left to right
     case 0x22: // dynamic rainbow rigth to left
-      if (++frameCount >= huePeriod) {
-        frameCount = 0;
+      if (++style.frameCount >= huePeriod) {
+        style.frameCount = 0;
       }
       huePeriod = NUM_LEDS;
       break;
     case 0x21: // dynamic rainbow left to right (slow)
     case 0x23: // dynamic rainbow rigth to left (slow)
       huePeriod = NUM_LEDS;
-      if (++frameCount >= huePeriod * timeScalar) {
-        frameCount = 0;
+      if (++style.frameCount >= huePeriod * timeScalar) {
+        style.frameCount = 0;
       }
       break;
 
     case 0x24: // dynamic rainbow breath
       huePeriod = 255;
-      if (++frameCount >= huePeriod) {
-        frameCount = 0;
+      if (++style.frameCount >= huePeriod) {
+        style.frameCount = 0;
       }
       break;
     case 0x25: // dynamic rainbow breath (slow)
       huePeriod = 255 * timeScalar;
-      if (++frameCount >= huePeriod) {
-        frameCount = 0;
+      if (++style.frameCount >= huePeriod) {
+        style.frameCount = 0;
       }
       break;
 
@@ -171,72 +286,226 @@ void blendBgColors() {
       break;
   }
 
-  if (bgAnimation == 0x14) { // change all brightness
+  uint8_t bandBrightness[ENERGY_BAND_NUM];
+  if (style.animation == 0x32) { // octave bands
+    for (uint8_t b = 0; b < ENERGY_BAND_NUM; ++b) {
+      uint8_t bandRatio = getBandEnergyRatio(b);
+      bandBrightness[b] = idleBrightness + ((int16_t(activatedBrightness - idleBrightness) * bandRatio) >> 8);
+    }
+  }
+
+  if (style.animation == 0x14 || style.animation == 0x30) { // change all brightness
     idleBrightness = uint8_t(float(activatedBrightness - idleBrightness) * powerRatio + 0.5 + float(idleBrightness));
   }
+#ifdef SESSION_STATS
+  const uint8_t heatIdleBrightness = idleBrightness;
+  const int16_t heatBrightnessRange = int16_t(activatedBrightness) - idleBrightness;
+#endif
+
+  // Hue count of LED j = hueOffset + j * hueStep
+  int hueOffset = style.frameCount;
+  uint8_t hueStep = 1;
+  switch (style.animation) {
+    case 0x01: // no animation
+    case 0x10: // jump from left
+    case 0x11: // jump from right
+    case 0x12: // jump from both sides
+    case 0x13: // jump from middle
+    case 0x14: // change all brightness
+    case 0x30: // change all brightness with playing energy
+    case 0x31: // jump from middle with playing energy
+    case 0x32: // octave bands with playing energy
+    case 0x22: // dynamic rainbow rigth to left
+      break;
+
+    case 0x20: // dynamic rainbow left to right
+      hueOffset = huePeriod - style.frameCount;
+      break;
+    case 0x21: // dynamic rainbow left to right (slow)
+      hueOffset = (huePeriod - style.frameCount) / timeScalar;
+      break;
+    case 0x23: // dynamic rainbow rigth to left (slow)
+      hueOffset = style.frameCount / timeScalar;
+      break;
+
+    case 0x24:
+    case 0x25: // dynamic rainbow breath
+      hueStep = 0;
+      break;
+
+#ifdef SESSION_STATS
+    case 0x40: // heatmap of the session, hue is set for each LED
+      hueStep = 0;
+      break;
+#endif
+
+    default: // turn off
+      hueOffset = 0;
+      hueStep = 0;
+      idleBrightness = 0;
+      break;
+  }
 
-  for (int j = 0; j < NUM_LEDS; ++j) {
-    bool activated = false;
-    switch (bgAnimation) {
-      case 0x01: // no animation
-        hueCount = j + frameCount;
-        break;
-
-      case 0x10: // jump from left
-        activated = j < activatedLedNum;
-        hueCount = j + frameCount;
-        break;
-
-      case 0x11: // jump from right
-        activated = j > NUM_LEDS - 1 - activatedLedNum;
-        hueCount = j + frameCount;
-        break;
-
-      case 0x12: // jump from both sides
-        activated = j < leftActivatedNum || j > (NUM_LEDS - rightActivatedNum);
-        hueCount = j + frameCount;
-        break;
-
-      case 0x13: // jump from middle
-        activated = j > NUM_LEDS / 2 - leftActivatedNum && j < NUM_LEDS / 2 + rightActivatedNum;
-        hueCount = j + frameCount;
-        break;
-
-      case 0x14: // change all brightness
-        hueCount = j + frameCount;
-        break;
-
-      case 0x20: // dynamic rainbow left to right
-        hueCount = j + huePeriod - frameCount;
-        break;
-      case 0x21: // dynamic rainbow left to right (slow)
-        hueCount = j + (huePeriod - frameCount) / timeScalar;
-        break;
-
-      case 0x22: // dynamic rainbow rigth to left
-        hueCount = j + frameCount;
-        break;
-      case 0x23: // dynamic rainbow rigth to left (slow)
-        hueCount = j + frameCount / timeScalar;
-        break;
-
-      case 0x24:
-      case 0x25: // dynamic rainbow breath
-        hueCount = frameCount;
-        break;
-
-      default: // turn off
-        idleBrightness = 0;
-        break;
+  for (int j = 0; j < NUM_LEDS;) {
+    // Fill a span of LEDs with the same color code, saturation & brightness at once
+    bool activated = isBgLedActivated(style.animation, j, activatedLedNum, leftActivatedNum, rightActivatedNum);
+    uint8_t band = (style.animation == 0x32) ? getLedEnergyBand(j) : 0;
+    int spanEnd = j + 1;
+    if (style.animation != 0x40) {
+      while (spanEnd < NUM_LEDS
+             && isBgLedActivated(style.animation, spanEnd, activatedLedNum, leftActivatedNum, rightActivatedNum) == activated
+             && (style.animation != 0x32 || getLedEnergyBand(spanEnd) == band)) {
+        ++spanEnd;
+      }
     }
+    uint8_t count = spanEnd - j;
+    int hueCount = hueOffset + j * hueStep;
 
     if (activated) {
-      leds[j] = getColorByCode(bgColorActivated, hueCount, huePeriod, activatedSaturation, activatedBrightness);
+      fillColorSpan(&leds[j], count, style.colorActivated, hueCount, hueStep, huePeriod, activatedSaturation, activatedBrightness, mix);
+    } else if (style.animation == 0x32) {
+      fillColorSpan(&leds[j], count, style.colorIdle, hueCount, hueStep, huePeriod, idleSaturation, bandBrightness[band], mix);
+#ifdef SESSION_STATS
+    } else if (style.animation == 0x40) {
+      uint8_t heat = getKeyHeat(getLedKey(j));
+      hueCount = (uint16_t(heat) * huePeriod) >> 9; // first half of the period: start hue -> stop hue of gradient
+      uint8_t heatBrightness = heatIdleBrightness + ((heatBrightnessRange * heat) >> 8);
+      fillColorSpan(&leds[j], 1, style.colorIdle, hueCount, 0, huePeriod, idleSaturation, heatBrightness, mix);
+#endif
     } else {
-      leds[j] = getColorByCode(bgColorIdle, hueCount, huePeriod, idleSaturation, idleBrightness);
+      fillColorSpan(&leds[j], count, style.colorIdle, hueCount, hueStep, huePeriod, idleSaturation, idleBrightness, mix);
+    }
+    j = spanEnd;
+  }
+}
+
+#ifdef STYLE_TRANSITION
+BgStyle transitionStyle = {0x00, 0x00, 0x00, 0x00, 0x00, 0}; // outgoing style, starts from black
+uint8_t transitionFrames = STYLE_TRANSITION_FRAMES; // remaining frames of transition
+#endif
+
+void getCurrentBgStyle(BgStyle& style) {
+  style.animation = bgAnimation;
+  style.colorIdle = bgColorIdle;
+  style.svIdle = bgSVIdle;
+  style.colorActivated = bgColorActivated;
+  style.svActivated = bgSVActivated;
+  style.frameCount = frameCount;
+}
+
+void startStyleTransition() {
+  // Call before the background style is changed
+#ifdef STYLE_TRANSITION
+  if (transitionFrames == 0) { // otherwise keep fading out the older style
+    getCurrentBgStyle(transitionStyle);
+  }
+  transitionFrames = STYLE_TRANSITION_FRAMES;
+#endif
+}
+
+#ifdef SPARSE_BACKGROUND
+BgStyle cachedBgStyle; // style of the background in leds[]
+bool bgCacheValid = false;
+uint8_t bgDirtyMask[(NUM_LEDS + 7) / 8]; // LEDs drawn over the cached background since the last frame
+
+inline void markBgDirty(uint8_t ledNum) {
+  bgDirtyMask[ledNum >> 3] |= 1 << (ledNum & 0x07);
+}
+
+void invalidateBgCache() {
+  // Call when leds[] is drawn over without marking LEDs dirty (settings overlay, error flash ...)
+  bgCacheValid = false;
+}
+
+bool isStaticBg(const BgStyle& style) {
+  return style.animation == 0x00 || style.animation == 0x01;
+}
+
+bool isSameBgStyle(const BgStyle& a, const BgStyle& b) {
+  return a.animation == b.animation && a.colorIdle == b.colorIdle && a.svIdle == b.svIdle
+         && a.colorActivated == b.colorActivated && a.svActivated == b.svActivated && a.frameCount == b.frameCount;
+}
+
+CRGB getStaticBgColor(const BgStyle& style, uint8_t ledNum) {
+  // Same color as renderBgStyle() for background animation 0x00 & 0x01
+  uint8_t idleSaturation = (style.svIdle & 0xF0) | bgSIdleOffset;
+  if (style.animation == 0x00) { // turn off
+    return getColorByCode(style.colorIdle, 0, NUM_LEDS, idleSaturation, 0);
+  }
+  uint8_t idleBrightness = ((style.svIdle & 0x0F) << 4) | bgVIdleOffset;
+  return getColorByCode(style.colorIdle, ledNum + style.frameCount, NUM_LEDS, idleSaturation, idleBrightness);
+}
+
+void restoreDirtyBg(const BgStyle& style) {
+  for (uint8_t i = 0; i < sizeof(bgDirtyMask); ++i) {
+    uint8_t mask = bgDirtyMask[i];
+    if (mask == 0) {
+      continue;
     }
+    for (uint8_t b = 0; b < 8; ++b) {
+      if (mask & (1 << b)) {
+        uint8_t ledNum = (i << 3) + b;
+        leds[ledNum] = getStaticBgColor(style, ledNum);
+      }
+    }
+    bgDirtyMask[i] = 0;
+  }
+}
+#endif
+
+void blendBgColors() {
+  BgStyle style;
+  getCurrentBgStyle(style);
+#ifdef SPARSE_BACKGROUND
+  bool transiting = false;
+#ifdef STYLE_TRANSITION
+  transiting = transitionFrames > 0;
+#endif
+  if (bgCacheValid && !transiting && isSameBgStyle(style, cachedBgStyle)) {
+    restoreDirtyBg(style); // only LEDs drawn by keys in the last frame
+    return;
+  }
+#endif
+  renderBgStyle(style, 0);
+  frameCount = style.frameCount;
+#ifdef STYLE_TRANSITION
+  if (transitionFrames > 0) { // render the outgoing style only during transition
+    uint16_t mix = (uint16_t(transitionFrames) << 8) / (STYLE_TRANSITION_FRAMES + 1);
+    renderBgStyle(transitionStyle, mix);
+    --transitionFrames;
+  }
+#endif
+#ifdef SPARSE_BACKGROUND
+  memset(bgDirtyMask, 0, sizeof(bgDirtyMask));
+  cachedBgStyle = style;
+  bgCacheValid = isStaticBg(style) && !transiting;
+#endif
+}
+
+void blendKeyLed(uint8_t ledNum, const CRGB& currentFgColor, uint8_t alpha) {
+  // Blend with 16-bit weight, round to 8-bit only once
+  uint16_t fgWeight = getAlphaWeight(alpha);
+  uint32_t fgScalar = uint32_t(fgWeight) + (fgWeight >> 15); // 0 - 65536
+  uint32_t bgScalar = 65536 - fgScalar;
+  CRGB& currentColor = leds[ledNum];
+#ifdef SPARSE_BACKGROUND
+  markBgDirty(ledNum);
+#endif
+  for (uint8_t c = 0; c < 3; ++c) {
+    currentColor[c] = uint8_t((currentColor[c] * bgScalar + currentFgColor[c] * fgScalar + 0x8000) >> 16);
+  }
+}
 
+void blendKeyColor(uint8_t keyIndex, const CRGB& currentFgColor, uint8_t alpha) {
+  // Blend key color to all LEDs of the key
+#ifdef KEY_SPAN_MAPPING
+  for (int k = 0; k < KEY_SPAN_MAX_LEDS && keySpan[keyIndex].weight[k] != 0; ++k) {
+    uint8_t spanAlpha = (uint16_t(alpha) * (keySpan[keyIndex].weight[k] + 1)) >> 8;
+    blendKeyLed(keySpan[keyIndex].startLed + k, currentFgColor, spanAlpha);
   }
+#else
+  blendKeyLed(getKeyLed(keyIndex), currentFgColor, alpha);
+#endif
 }
 
 void blendFgColors() {
@@ -246,14 +515,7 @@ void blendFgColors() {
   }
   for (int i = 0; i < NUM_KEYS; ++i) {
     if (keyData[i].alpha > 0) {
-      uint8_t ledNum = keyLedMap[i];
-      CRGB currentBgColor = leds[ledNum];
-      CRGB currentFgColor = getKeyColor(keyData[i], i, keyMidiMap[i]);
-      float fgAlpha = float(keyData[i].alpha) / MAX_ALPHA;
-      float newColorR = float(currentBgColor.r) * (1.0 - fgAlpha) + float(currentFgColor.r) * fgAlpha + 0.5;
-      float newColorG = float(currentBgColor.g) * (1.0 - fgAlpha) + float(currentFgColor.g) * fgAlpha + 0.5;
-      float newColorB = float(currentBgColor.b) * (1.0 - fgAlpha) + float(currentFgColor.b) * fgAlpha + 0.5;
-      leds[ledNum] = CRGB(uint8_t(newColorR), uint8_t(newColorG), uint8_t(newColorB));
+      blendKeyColor(i, getKeyColor(keyData[i], i, getKeyMidi(i)), keyData[i].alpha);
     }
   }
 }
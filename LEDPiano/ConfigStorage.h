@@ -1,34 +1,128 @@
 #ifndef CONFIG_STORAGE_H
 #define CONFIG_STORAGE_H
 
-#include "LEDPianoConfig.h"
+#include "ColorControl.h"
+
+/* Config data order (CONFIG_SIZE bytes), same as defaultConfig[]
+    0.bgAnimation
+    1.bgColorIdle
+    2.bgSVIdle
+    3.bgColorActivated
+    4.bgSVActivated
+    5.keyAnimation
+    6.whiteKeyColor
+    7.whiteKeySV
+    8.blackKeyColor
+    9.blackKeySV
+*/
+
+/* EEPROM layout
+    project title (projectTitleLength bytes), configNum (1 byte), config slots (NUM_SAVE_SLOTS * CONFIG_SIZE bytes),
+    FAST_BOOT: checksum record (BOOT_RECORD_SIZE bytes): mark, checksum of each slot
+    then CONFIG_STORAGE_END: free for other data (e.g. ReplayControl.h)
+*/
+#define BOOT_RECORD_ADDRESS (projectTitleLength + 1 + NUM_SAVE_SLOTS * CONFIG_SIZE)
+#ifdef FAST_BOOT
+#define BOOT_RECORD_MARK 0x5A
+#define BOOT_RECORD_SIZE (1 + NUM_SAVE_SLOTS)
+#define CONFIG_STORAGE_END (BOOT_RECORD_ADDRESS + BOOT_RECORD_SIZE)
+#else
+#define CONFIG_STORAGE_END BOOT_RECORD_ADDRESS
+#endif
+
+int getConfigAddress(uint8_t _configNum) {
+  return projectTitleLength + 1 + _configNum * CONFIG_SIZE;
+}
+
+#ifdef FAST_BOOT
+uint8_t configListSignature = 0; // checksum of the valid values of this firmware, see initConfigChecksum()
+
+uint8_t updateCrc8(uint8_t crc, uint8_t data) {
+  // CRC-8, polynomial 0x31
+  crc ^= data;
+  for (uint8_t b = 0; b < 8; ++b) {
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+  }
+  return crc;
+}
+
+uint8_t updateListCrc8(uint8_t crc, const uint8_t list[], uint8_t listLen) {
+  // list[] in PROGMEM
+  for (uint8_t i = 0; i < listLen; ++i) {
+    crc = updateCrc8(crc, readProgmem(&list[i]));
+  }
+  return updateCrc8(crc, listLen);
+}
+
+void initConfigChecksum() {
+  // A firmware with other valid values (lists, brightness limits) doesn't trust the checksums of the older one
+  uint8_t crc = 0xFF;
+  crc = updateListCrc8(crc, bgAnimationList, bgAnimationNum);
+  crc = updateListCrc8(crc, bgColorList, bgColorNum);
+  crc = updateListCrc8(crc, keyAnimationList, keyAnimationNum);
+  crc = updateListCrc8(crc, keyColorList, keyColorNum);
+  crc = updateCrc8(crc, MAX_BRIGHTNESS_BG);
+  configListSignature = updateCrc8(crc, MAX_BRIGHTNESS_FG);
+}
+
+uint8_t getConfigChecksum(const uint8_t config[]) {
+  uint8_t crc = configListSignature;
+  for (uint8_t i = 0; i < CONFIG_SIZE; ++i) {
+    crc = updateCrc8(crc, config[i]);
+  }
+  return crc;
+}
+
+bool isConfigChecked(uint8_t _configNum, const uint8_t config[]) {
+  // true if config was validated when its checksum was written
+  return readStorage(BOOT_RECORD_ADDRESS) == BOOT_RECORD_MARK
+         && readStorage(BOOT_RECORD_ADDRESS + 1 + _configNum) == getConfigChecksum(config);
+}
+
+void writeConfigChecksum(uint8_t _configNum, const uint8_t config[]) {
+  // config should be validated, call after config is written: if power is lost in between, the checksum doesn't match
+  writeStorage(BOOT_RECORD_ADDRESS + 1 + _configNum, getConfigChecksum(config));
+  writeStorage(BOOT_RECORD_ADDRESS, BOOT_RECORD_MARK);
+}
+#endif
+
+void readConfig(uint8_t _configNum, uint8_t config[]) {
+  int eepromPointer = getConfigAddress(_configNum);
+  for (int i = 0; i < CONFIG_SIZE; ++i) {
+    config[i] = readStorage(eepromPointer++);
+  }
+}
+
+void writeConfig(uint8_t _configNum, const uint8_t config[]) {
+  // config should be validated
+  int eepromPointer = getConfigAddress(_configNum);
+  for (int i = 0; i < CONFIG_SIZE; ++i) {
+    writeStorage(eepromPointer++, config[i]);
+  }
+#ifdef FAST_BOOT
+  writeConfigChecksum(_configNum, config);
+#endif
+}
 
 void initSaveSlots() {
   int eepromPointer = 0;
   for (int i = 0; i < projectTitleLength; ++i) { // write project title (as identicator)
-    EEPROM.update(eepromPointer++, projectTitle[i]);
+    writeStorage(eepromPointer++, readProgmem(&projectTitle[i]));
   }
   configNum = 0;
-  EEPROM.update(eepromPointer++, configNum);
+  writeStorage(eepromPointer++, configNum);
+  uint8_t config[CONFIG_SIZE];
   for (int i = 0; i < NUM_SAVE_SLOTS; ++i) {
-    EEPROM.update(eepromPointer++, defaultConfig[i][0]); // bgAnimation
-    EEPROM.update(eepromPointer++, defaultConfig[i][1]); // bgColorIdle
-    EEPROM.update(eepromPointer++, defaultConfig[i][2]); // bgSVIdle
-    EEPROM.update(eepromPointer++, defaultConfig[i][3]); // bgColorActivated
-    EEPROM.update(eepromPointer++, defaultConfig[i][4]); // bgSVActivated
-
-    EEPROM.update(eepromPointer++, defaultConfig[i][5]); // keyAnimation
-    EEPROM.update(eepromPointer++, defaultConfig[i][6]); // whiteKeyColor
-    EEPROM.update(eepromPointer++, defaultConfig[i][7]); // whiteKeySV
-    EEPROM.update(eepromPointer++, defaultConfig[i][8]); // blackKeyColor
-    EEPROM.update(eepromPointer++, defaultConfig[i][9]); // blackKeySV
+    memcpy_P(config, defaultConfig[i], CONFIG_SIZE);
+    writeConfig(i, config);
   }
+  commitStorage();
 }
 
 bool isSaveValid() {
   // read project title (as identicator)
   for (int i = 0; i < projectTitleLength; ++i) {
-    if (EEPROM.read(i) != projectTitle[i]) {
+    if (readStorage(i) != uint8_t(readProgmem(&projectTitle[i]))) {
       return false;
     }
   }
@@ -37,103 +131,202 @@ bool isSaveValid() {
 
 uint8_t readConfigNum() {
   int eepromPointer = projectTitleLength;
-  uint8_t rawData = EEPROM.read(eepromPointer);
+  uint8_t rawData = readStorage(eepromPointer);
   return (rawData < NUM_SAVE_SLOTS) ? rawData : 0;
 }
 
 void saveConfigNum(uint8_t _configNum) {
   int eepromPointer = projectTitleLength;
-  EEPROM.update(eepromPointer, _configNum < NUM_SAVE_SLOTS ? _configNum : 0);
+  writeStorage(eepromPointer, _configNum < NUM_SAVE_SLOTS ? _configNum : 0);
+  commitStorage(); // configs are always saved before the slot number
 }
 
-bool checkDataInList(uint8_t list[], uint8_t listLen, int& readPointer, uint8_t& writeBack) {
-  uint8_t rawData = EEPROM.read(readPointer++);
+bool checkDataInList(const uint8_t list[], uint8_t listLen, uint8_t& data) {
+  // list[] in PROGMEM
 #ifdef DEBUG
-  Serial.print("In List: ");
-  Serial.println(rawData, HEX);
+  Serial.print(F("In List: "));
+  Serial.println(data, HEX);
 #endif
   for (int i = 0; i < listLen; ++i) {
-    if (list[i] == rawData) {
-      writeBack = rawData;
+    if (readProgmem(&list[i]) == data) {
       return true;
     }
   }
 #ifdef DEBUG
-  Serial.println("^not in list");
+  Serial.println(F("^not in list"));
 #endif
-  writeBack = list[0];
+  data = readProgmem(&list[0]);
   return false;
 }
 
-bool readSVEEPROM(int& readPointer, uint8_t& writeBack, uint8_t maxV) {
-  uint8_t rawData = EEPROM.read(readPointer++);
+bool checkSV(uint8_t& data, uint8_t maxV) {
 #ifdef DEBUG
-  Serial.print("ReadSV: ");
-  Serial.println(rawData, HEX);
+  Serial.print(F("ReadSV: "));
+  Serial.println(data, HEX);
 #endif
-  if ((rawData & 0x0F) > maxV) { // Brigthness limit check
-    rawData = (rawData & 0xF0) | maxV;
-    writeBack = rawData;
+  if ((data & 0x0F) > maxV) { // Brigthness limit check
+    data = (data & 0xF0) | maxV;
 #ifdef DEBUG
-    Serial.println("^brigthness limit error");
+    Serial.println(F("^brigthness limit error"));
 #endif
     return false;
   }
-  writeBack = rawData;
   return true;
 }
 
-bool loadSetting(uint8_t _configNum) {
-  int eepromPointer = projectTitleLength + 1 + _configNum * CONFIG_SIZE;
+bool validateConfigSV(uint8_t config[]) {
+  // Brightness (power) limits only, cheap enough for every read
+  bool noError = true;
+
+  noError &= checkSV(config[2], MAX_BRIGHTNESS_BG);
+  noError &= checkSV(config[4], MAX_BRIGHTNESS_BG);
+  noError &= checkSV(config[7], MAX_BRIGHTNESS_FG);
+  noError &= checkSV(config[9], MAX_BRIGHTNESS_FG);
+
+  return noError;
+}
+
+bool validateConfig(uint8_t config[]) {
+  // Replace invalid data, return false if any data is replaced
   bool noError = true;
 
-  noError &= checkDataInList(bgAnimationList, bgAnimationNum, eepromPointer, bgAnimation);
-  noError &= checkDataInList(bgColorList, bgColorNum, eepromPointer, bgColorIdle);
-  noError &= readSVEEPROM(eepromPointer, bgSVIdle, MAX_BRIGHTNESS_BG);
-  noError &= checkDataInList(bgColorList, bgColorNum, eepromPointer, bgColorActivated);
-  noError &= readSVEEPROM(eepromPointer, bgSVActivated, MAX_BRIGHTNESS_BG);
+  noError &= checkDataInList(bgAnimationList, bgAnimationNum, config[0]);
+  noError &= checkDataInList(bgColorList, bgColorNum, config[1]);
+  noError &= checkDataInList(bgColorList, bgColorNum, config[3]);
 
-  noError &= checkDataInList(keyAnimationList, keyAnimationNum, eepromPointer, keyAnimation);
-  noError &= checkDataInList(keyColorList, keyColorNum, eepromPointer, whiteKeyColor);
-  noError &= readSVEEPROM(eepromPointer, whiteKeySV, MAX_BRIGHTNESS_FG);
-  noError &= checkDataInList(keyColorList, keyColorNum, eepromPointer, blackKeyColor);
-  noError &= readSVEEPROM(eepromPointer, blackKeySV, MAX_BRIGHTNESS_FG);
+  noError &= checkDataInList(keyAnimationList, keyAnimationNum, config[5]);
+  noError &= checkDataInList(keyColorList, keyColorNum, config[6]);
+  noError &= checkDataInList(keyColorList, keyColorNum, config[8]);
 
+  noError &= validateConfigSV(config);
+  return noError;
+}
+
+bool readValidConfig(uint8_t _configNum, uint8_t config[]) {
+  // Read & validate a slot, return false if any data is replaced
+  readConfig(_configNum, config);
+#ifdef FAST_BOOT
+  if (isConfigChecked(_configNum, config)) {
+    // List searches were done before, the brightness limit is checked anyway (a corrupted slot may match by chance)
+    return validateConfigSV(config);
+  }
+#endif
+  bool noError = validateConfig(config);
+#ifdef FAST_BOOT
+  if (noError) {
+    writeConfigChecksum(_configNum, config); // e.g. first boot with FAST_BOOT or new firmware
+  }
+#endif
+  return noError;
+}
+
+void setConfigValues(const uint8_t config[]) {
+  // config should be validated, setupKeyAnimation() is not called
+  startStyleTransition();
+  bgAnimation = config[0];
+  bgColorIdle = config[1];
+  bgSVIdle = config[2];
+  bgColorActivated = config[3];
+  bgSVActivated = config[4];
+
+  keyAnimation = config[5];
+  whiteKeyColor = config[6];
+  whiteKeySV = config[7];
+  blackKeyColor = config[8];
+  blackKeySV = config[9];
+}
+
+void applyConfig(const uint8_t config[]) {
+  // config should be validated
+  setConfigValues(config);
   setupKeyAnimation();
+}
+
+void getCurrentConfig(uint8_t config[]) {
+  config[0] = bgAnimation;
+  config[1] = bgColorIdle;
+  config[2] = bgSVIdle;
+  config[3] = bgColorActivated;
+  config[4] = bgSVActivated;
+
+  config[5] = keyAnimation;
+  config[6] = whiteKeyColor;
+  config[7] = whiteKeySV;
+  config[8] = blackKeyColor;
+  config[9] = blackKeySV;
+}
+
+#ifdef CONFIG_CACHE
+uint8_t configCache[NUM_SAVE_SLOTS][CONFIG_SIZE]; // validated copy of all slots
+uint8_t configCacheVersion = 0; // changed whenever configCache is modified
+
+void loadConfigCache() {
+  for (int i = 0; i < NUM_SAVE_SLOTS; ++i) {
+    readValidConfig(i, configCache[i]);
+  }
+  ++configCacheVersion;
+}
+
+void storeConfigCache(uint8_t _configNum, const uint8_t config[]) {
+  // config should be validated
+  memcpy(configCache[_configNum], config, CONFIG_SIZE);
+  ++configCacheVersion;
+}
+
+void saveConfigCache() {
+  for (int i = 0; i < NUM_SAVE_SLOTS; ++i) {
+    writeConfig(i, configCache[i]);
+  }
+}
+#endif
+
+bool loadSetting(uint8_t _configNum) {
+  uint8_t config[CONFIG_SIZE];
+  bool noError = readValidConfig(_configNum, config);
+  applyConfig(config);
   return noError;
 }
 
 void checkSavedConfig() {
+#ifdef FAST_BOOT
+  initConfigChecksum();
+#endif
   if (!isSaveValid()) {
 #ifdef DEBUG
-    Serial.println("init EEPROM");
+    Serial.println(F("init EEPROM"));
 #endif
     initSaveSlots();
   }
   configNum = readConfigNum();
+#ifdef CONFIG_CACHE
+  loadConfigCache(); // reads each slot once, the selected one included
+  applyConfig(configCache[configNum]);
+#else
   loadSetting(configNum);
+#endif
+#ifdef FAST_BOOT
+  commitStorage(); // checksums written by readValidConfig()
+#endif
 }
 
 void saveCurrentConfig(uint8_t _configNum) {
-  int eepromPointer = projectTitleLength + 1 + _configNum * CONFIG_SIZE;
-  EEPROM.update(eepromPointer++, bgAnimation);
-  EEPROM.update(eepromPointer++, bgColorIdle);
-  EEPROM.update(eepromPointer++, bgSVIdle);
-  EEPROM.update(eepromPointer++, bgColorActivated);
-  EEPROM.update(eepromPointer++, bgSVActivated);
-
-  EEPROM.update(eepromPointer++, keyAnimation);
-  EEPROM.update(eepromPointer++, whiteKeyColor);
-  EEPROM.update(eepromPointer++, whiteKeySV);
-  EEPROM.update(eepromPointer++, blackKeyColor);
-  EEPROM.update(eepromPointer++, blackKeySV);
+  uint8_t config[CONFIG_SIZE];
+  getCurrentConfig(config);
+  writeConfig(_configNum, config);
+#ifdef CONFIG_CACHE
+  storeConfigCache(_configNum, config);
+#endif
 }
 
 void switchToConfig(uint8_t _configNum) {
   if (_configNum != configNum) {
     saveCurrentConfig(configNum);
     configNum = _configNum;
+#ifdef CONFIG_CACHE
+    applyConfig(configCache[configNum]);
+#else
     loadSetting(configNum);
+#endif
   }
 }
 
@@ -0,0 +1,86 @@
+#ifndef CONNECTION_CONTROL_H
+#define CONNECTION_CONTROL_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   USB host & instrument connection states (systemStatus in loop()):
+     0x40 USB error: retryMidiHost() calls initMidiHost() again with exponential backoff, error flash meanwhile
+     0x20 seeking MIDI: USB host polled until the instrument is enumerated,
+          the style keeps running for MIDI_RECONNECT_TIME after the instrument is lost (isReconnecting())
+     0x30 main / setting: instrument connected
+   Nothing blocks loop(), so frames keep coming while the USB host retries or re-enumerates.
+*/
+
+uint32_t usbRetryTime = 0; // millis() of the next init attempt
+uint16_t usbRetryDelay = USB_RETRY_MIN_TIME;
+uint16_t usbInitFailCount = 0;
+
+bool midiLost = false; // instrument unplugged, not connected again yet
+uint32_t midiLostTime = 0; // millis() when the instrument was unplugged
+uint16_t reconnectCount = 0;
+uint32_t lastReconnectTime = 0; // ms from unplugged to connected again
+uint32_t maxReconnectTime = 0;
+
+void scheduleMidiHostRetry() {
+  // Call when initMidiHost() failed
+  if (usbInitFailCount < 0xFFFF) {
+    ++usbInitFailCount;
+  }
+  usbRetryTime = millis() + usbRetryDelay;
+  usbRetryDelay = (usbRetryDelay >= USB_RETRY_MAX_TIME / 2) ? USB_RETRY_MAX_TIME : usbRetryDelay * 2;
+}
+
+bool retryMidiHost() {
+  // Call in every loop() while USB host is not working, true once it is initialized
+  if (int32_t(millis() - usbRetryTime) < 0) {
+    return false;
+  }
+  if (!initMidiHost()) {
+    scheduleMidiHostRetry();
+    return false;
+  }
+  usbRetryDelay = USB_RETRY_MIN_TIME;
+  return true;
+}
+
+void recordMidiLost() {
+  midiLost = true;
+  midiLostTime = millis();
+}
+
+void recordMidiFound() {
+  if (!midiLost) {
+    return; // first connection
+  }
+  lastReconnectTime = millis() - midiLostTime;
+  if (lastReconnectTime > maxReconnectTime) {
+    maxReconnectTime = lastReconnectTime;
+  }
+  if (reconnectCount < 0xFFFF) {
+    ++reconnectCount;
+  }
+  midiLost = false;
+}
+
+bool isReconnecting() {
+  // Instrument lost recently, keep showing the style
+  return midiLost && millis() - midiLostTime < MIDI_RECONNECT_TIME;
+}
+
+void printConnectionState() {
+  Serial.print(F("USB init failures: "));
+  Serial.println(usbInitFailCount);
+  Serial.print(F("Reconnects: "));
+  Serial.print(reconnectCount);
+  Serial.print(F(", last (ms): "));
+  Serial.print(lastReconnectTime);
+  Serial.print(F(", max (ms): "));
+  Serial.println(maxReconnectTime);
+  if (midiLost) {
+    Serial.print(F("Lost for (ms): "));
+    Serial.println(millis() - midiLostTime);
+  }
+}
+
+#endif
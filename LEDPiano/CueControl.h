@@ -0,0 +1,99 @@
+#ifndef CUE_CONTROL_H
+#define CUE_CONTROL_H
+
+#include "ConfigStorage.h"
+
+/*
+   Cue sequencer (CUE_SEQUENCER in LEDPianoConfig.h)
+   Program Change (0xC?) selects the cue with the same bank & program in cueList[], Bank Select MSB (0xB?, CC 0) sets the bank.
+   All slots are validated once into configCache[], the cue after the current one (in cueList[] order) is staged
+   in idle time with its key animation factors, so the staged cue is applied by plain copies.
+   Other cues are applied from configCache[] (still no EEPROM access or validation).
+   Cue changes are not saved to EEPROM, the confirm key saves the current style to the slot of the current cue.
+*/
+#ifdef CUE_SEQUENCER
+
+struct CueStage {
+  uint8_t cue; // 0xFF: empty
+  uint8_t version; // configCacheVersion when staged
+  uint8_t config[CONFIG_SIZE];
+  float increaseFactor;
+  float fadeFactorPress;
+  float fadeFactorRelease;
+};
+
+CueStage cueStage = {0xFF, 0x00, {0x00}, 0.0, 0.0, 0.0}; // empty
+uint8_t cueBank = 0;
+uint8_t cueIndex = 0xFF; // current cue, 0xFF: none
+bool cueStagePending = true;
+
+uint8_t getCueSlot(uint8_t cue) {
+  uint8_t slot = pgm_read_byte(&cueList[cue][2]);
+  return slot < NUM_SAVE_SLOTS ? slot : 0;
+}
+
+uint8_t findCue(uint8_t bank, uint8_t program) {
+  for (uint8_t i = 0; i < cueNum; ++i) {
+    if (pgm_read_byte(&cueList[i][0]) == bank && pgm_read_byte(&cueList[i][1]) == program) {
+      return i;
+    }
+  }
+  return 0xFF;
+}
+
+void stageCue(uint8_t cue) {
+  const uint8_t* config = configCache[getCueSlot(cue)];
+  memcpy(cueStage.config, config, CONFIG_SIZE);
+  cueStage.increaseFactor = increaseFactor;
+  cueStage.fadeFactorPress = fadeFactorPress;
+  cueStage.fadeFactorRelease = fadeFactorRelease;
+  getKeyAnimationFactors(config[5], cueStage.increaseFactor, cueStage.fadeFactorPress, cueStage.fadeFactorRelease);
+  cueStage.version = configCacheVersion;
+  cueStage.cue = cue;
+}
+
+void updateCueStage() {
+  // Call in idle time (not while processing MIDI)
+  if (cueStagePending || (cueStage.cue != 0xFF && cueStage.version != configCacheVersion)) {
+    uint8_t nextCue = (cueIndex == 0xFF || cueIndex + 1 >= cueNum) ? 0 : cueIndex + 1;
+    stageCue(nextCue);
+    cueStagePending = false;
+  }
+}
+
+void applyCue(uint8_t cue) {
+  if (cue == cueStage.cue && cueStage.version == configCacheVersion) {
+    setConfigValues(cueStage.config);
+    increaseFactor = cueStage.increaseFactor;
+    fadeFactorPress = cueStage.fadeFactorPress;
+    fadeFactorRelease = cueStage.fadeFactorRelease;
+  } else {
+    applyConfig(configCache[getCueSlot(cue)]);
+  }
+  configNum = getCueSlot(cue);
+  cueIndex = cue;
+  cueStagePending = true;
+#ifdef DEBUG
+  Serial.print(F("Cue: "));
+  Serial.println(cue);
+#endif
+}
+
+void processCue(uint8_t outBuf[]) {
+  uint8_t statusCode = outBuf[1] & 0xF0;
+  if (CUE_CHANNEL <= 0x0F && (outBuf[1] & 0x0F) != CUE_CHANNEL) {
+    return;
+  }
+  if (statusCode == 0xB0 && outBuf[2] == 0x00) { // Bank Select MSB
+    cueBank = outBuf[3];
+  } else if (statusCode == 0xC0) { // Program Change
+    uint8_t cue = findCue(cueBank, outBuf[2]);
+    if (cue != 0xFF) {
+      applyCue(cue);
+    }
+  }
+}
+
+#endif
+
+#endif
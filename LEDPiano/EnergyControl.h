@@ -0,0 +1,64 @@
+#ifndef ENERGY_CONTROL_H
+#define ENERGY_CONTROL_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   MIDI energy tracker for background animation 0x30 - 0x32
+   Note on events add velocity impulses to the total energy and to the octave band of the key,
+   impulses decay every frame, and the output level follows them with attack / release smoothing.
+   Cost: O(1) per note on event, O(ENERGY_BAND_NUM) per frame, no scan of keys.
+   Impulses saturate at 0xFFFF, so the rounding terms are added in 32 bits (16-bit int on AVR would wrap).
+*/
+#define ENERGY_BAND_NUM ((NUM_KEYS + 11) / 12) // one band per octave (12 keys), from the leftmost key
+#define ENERGY_DECAY_SHIFT 5 // impulse -= impulse / 32 per frame (~0.5 s)
+#define ENERGY_ATTACK_SHIFT 1 // level += (impulse - level) / 2 per frame
+#define ENERGY_RELEASE_SHIFT 3 // level -= (level - impulse) / 8 per frame
+#define ENERGY_FULL 6144 // about 8 notes per second at velocity 100
+#define BAND_ENERGY_FULL 2048
+
+uint16_t energyImpulse = 0;
+uint16_t energyLevel = 0;
+uint16_t bandImpulse[ENERGY_BAND_NUM];
+uint16_t bandLevel[ENERGY_BAND_NUM];
+
+uint8_t getLedEnergyBand(uint8_t ledIndex) {
+  return getLedKey(ledIndex) / 12; // band of the key under the LED, same as addNoteEnergy()
+}
+
+void addNoteEnergy(uint8_t keyIndex, uint8_t velocity) {
+  uint16_t impulse = uint16_t(velocity) << 4;
+  uint8_t band = keyIndex / 12;
+  energyImpulse = (energyImpulse > 0xFFFF - impulse) ? 0xFFFF : energyImpulse + impulse;
+  bandImpulse[band] = (bandImpulse[band] > 0xFFFF - impulse) ? 0xFFFF : bandImpulse[band] + impulse;
+}
+
+uint16_t followEnergy(uint16_t level, uint16_t impulse) {
+  if (impulse > level) {
+    return level + uint16_t((uint32_t(impulse - level) + (1 << ENERGY_ATTACK_SHIFT) - 1) >> ENERGY_ATTACK_SHIFT);
+  }
+  return level - uint16_t((uint32_t(level - impulse) + (1 << ENERGY_RELEASE_SHIFT) - 1) >> ENERGY_RELEASE_SHIFT);
+}
+
+uint16_t decayEnergy(uint16_t impulse) {
+  return impulse - uint16_t((uint32_t(impulse) + (1 << ENERGY_DECAY_SHIFT) - 1) >> ENERGY_DECAY_SHIFT);
+}
+
+void updateEnergy() {
+  energyImpulse = decayEnergy(energyImpulse);
+  energyLevel = followEnergy(energyLevel, energyImpulse);
+  for (uint8_t b = 0; b < ENERGY_BAND_NUM; ++b) {
+    bandImpulse[b] = decayEnergy(bandImpulse[b]);
+    bandLevel[b] = followEnergy(bandLevel[b], bandImpulse[b]);
+  }
+}
+
+uint8_t getEnergyRatio() { // 0 - 255
+  return energyLevel >= ENERGY_FULL ? 0xFF : uint8_t(uint32_t(energyLevel) * 0xFF / ENERGY_FULL);
+}
+
+uint8_t getBandEnergyRatio(uint8_t band) { // 0 - 255
+  return bandLevel[band] >= BAND_ENERGY_FULL ? 0xFF : uint8_t(uint32_t(bandLevel[band]) * 0xFF / BAND_ENERGY_FULL);
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef FRAME_CONTROL_H
+#define FRAME_CONTROL_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   Frame timing (interval between two FastLED.show() calls, in microseconds)
+   Used to compare render modes: render on tick vs. RENDER_AHEAD
+*/
+uint32_t lastShowTime = 0;
+uint32_t minFrameInterval = 0xFFFFFFFF;
+uint32_t maxFrameInterval = 0;
+uint16_t frameIntervalCount = 0;
+uint16_t frameOverrunCount = 0; // frames shown later than 1.25 frame period
+
+void resetFrameInterval() {
+  lastShowTime = 0;
+  minFrameInterval = 0xFFFFFFFF;
+  maxFrameInterval = 0;
+  frameIntervalCount = 0;
+}
+
+#ifdef DEBUG
+void debugPrintFrameJitter() {
+  Serial.print(F("Frame[us] min="));
+  Serial.print(minFrameInterval);
+  Serial.print(F(" max="));
+  Serial.print(maxFrameInterval);
+  Serial.print(F(" jitter="));
+  Serial.println(maxFrameInterval - minFrameInterval);
+}
+#endif
+
+void recordFrameInterval() {
+  uint32_t currentTime = micros();
+  if (lastShowTime != 0) {
+    uint32_t frameInterval = currentTime - lastShowTime;
+    if (frameInterval < minFrameInterval) {
+      minFrameInterval = frameInterval;
+    }
+    if (frameInterval > maxFrameInterval) {
+      maxFrameInterval = frameInterval;
+    }
+    if (frameInterval > 1250000UL / FPS && frameOverrunCount < 0xFFFF) {
+      ++frameOverrunCount;
+    }
+    if (++frameIntervalCount >= FPS) { // report once per second
+#ifdef DEBUG
+      debugPrintFrameJitter();
+#endif
+      minFrameInterval = 0xFFFFFFFF;
+      maxFrameInterval = 0;
+      frameIntervalCount = 0;
+    }
+  }
+  lastShowTime = currentTime;
+}
+
+#endif
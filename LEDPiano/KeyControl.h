@@ -3,9 +3,33 @@
 
 #include "LEDPianoConfig.h"
 
+#ifdef KEY_SPAN_MAPPING
+void initKeySpans() {
+  // Positions in LEDs with 8 fractional bits
+  for (int i = 0; i < NUM_KEYS; ++i) {
+    uint16_t spanStart = uint16_t(uint32_t(i) * PIANO_WIDTH_MM * LEDS_PER_METER / NUM_KEYS * 256 / 1000);
+    uint16_t spanEnd = uint16_t(uint32_t(i + 1) * PIANO_WIDTH_MM * LEDS_PER_METER / NUM_KEYS * 256 / 1000);
+    uint8_t startLed = spanStart >> 8;
+    keySpan[i].startLed = startLed;
+    for (int k = 0; k < KEY_SPAN_MAX_LEDS; ++k) {
+      uint16_t ledStart = uint16_t(startLed + k) << 8;
+      uint16_t ledEnd = ledStart + 256;
+      uint16_t coverStart = spanStart > ledStart ? spanStart : ledStart;
+      uint16_t coverEnd = spanEnd < ledEnd ? spanEnd : ledEnd;
+      if (startLed + k >= NUM_LEDS || coverEnd <= coverStart) {
+        keySpan[i].weight[k] = 0;
+      } else {
+        uint16_t coverage = coverEnd - coverStart; // 1 - 256
+        keySpan[i].weight[k] = uint8_t(coverage - (coverage >> 8)); // 256 -> 255
+      }
+    }
+  }
+}
+#endif
+
 void initKeys() {
   for (int i = 0; i < NUM_KEYS; ++i) {
-    uint8_t currentMidiCode = keyMidiMap[i];
+    uint8_t currentMidiCode = getKeyMidi(i);
     keyData[i].alpha = 0;
     uint8_t noteNameNum = currentMidiCode % 12;
     uint8_t controlCode = 0x01; // initial color cache is white
@@ -21,6 +45,9 @@ void initKeys() {
     }
     keyData[i].control = controlCode;
   }
+#ifdef KEY_SPAN_MAPPING
+  initKeySpans();
+#endif
 }
 
 float getPowerRatio() {
@@ -43,7 +70,8 @@ float getPowerRatio() {
   return res;
 }
 
-void setupKeyAnimation() {
+void getKeyAnimationFactors(uint8_t animation, float& increase, float& fadePress, float& fadeRelease) {
+  // Factors of updateKeyAlpha(), unchanged if animation is unknown
   const static float increaseNone = 0.0;
   const static float increaseSlow = 0.03;
   const static float increaseFast = 0.97;
@@ -53,96 +81,136 @@ void setupKeyAnimation() {
   const static float fadeNone = 1.0;
 
   // Notice: Remember to add your new code to keyAnimationList[]
-  switch (keyAnimation) {
+  switch (animation) {
     case 0: // ↑↘↓ without rendering
-      increaseFactor = 0.0;
-      fadeFactorPress = fadeSlow;
-      fadeFactorRelease = fadeFast;
+      increase = 0.0;
+      fadePress = fadeSlow;
+      fadeRelease = fadeFast;
       break;
 
     case 1: // ↑↘↓
-      increaseFactor = 0.0;
-      fadeFactorPress = fadeSlow;
-      fadeFactorRelease = fadeFast;
+      increase = 0.0;
+      fadePress = fadeSlow;
+      fadeRelease = fadeFast;
       break;
 
     case 2: // ↑→↓
-      increaseFactor = 0.0;
-      fadeFactorPress = fadeNone;
-      fadeFactorRelease = fadeFast;
+      increase = 0.0;
+      fadePress = fadeNone;
+      fadeRelease = fadeFast;
       break;
 
     case 3: // ↑→↘
-      increaseFactor = 0.0;
-      fadeFactorPress = fadeNone;
-      fadeFactorRelease = fadeSlow;
+      increase = 0.0;
+      fadePress = fadeNone;
+      fadeRelease = fadeSlow;
       break;
 
     case 4: // ↑↘↘
-      increaseFactor = 0.0;
-      fadeFactorPress = fadeSlow;
-      fadeFactorRelease = fadeMedian;
+      increase = 0.0;
+      fadePress = fadeSlow;
+      fadeRelease = fadeMedian;
       break;
 
     case 5: // ↗→↘
-      increaseFactor = increaseSlow;
-      fadeFactorPress = fadeNone;
-      fadeFactorRelease = fadeMedian;
+      increase = increaseSlow;
+      fadePress = fadeNone;
+      fadeRelease = fadeMedian;
       break;
 
     case 6: // ↗↘↘
-      increaseFactor = increaseSlow;
-      fadeFactorPress = fadeSlow;
-      fadeFactorRelease = fadeMedian;
+      increase = increaseSlow;
+      fadePress = fadeSlow;
+      fadeRelease = fadeMedian;
       break;
 
     case 7: // ↑→↓ (no velocity)
-      increaseFactor = increaseFast;
-      fadeFactorPress = fadeNone;
-      fadeFactorRelease = fadeFast;
+      increase = increaseFast;
+      fadePress = fadeNone;
+      fadeRelease = fadeFast;
       break;
 
     case 8: // ↑↘↓ (no velocity)
-      increaseFactor = increaseFast;
-      fadeFactorPress = fadeSlow;
-      fadeFactorRelease = fadeFast;
+      increase = increaseFast;
+      fadePress = fadeSlow;
+      fadeRelease = fadeFast;
       break;
 
     case 9: // ↑↓↓ (fast flash)
-      increaseFactor = increaseFast;
-      fadeFactorPress = fadeFast;
-      fadeFactorRelease = fadeFast;
+      increase = increaseFast;
+      fadePress = fadeFast;
+      fadeRelease = fadeFast;
+      break;
+
+#ifdef PARTICLE_EFFECT
+    case 10: // ↑↘↓ + ripple
+    case 11: // ↑↘↓ + sparks
+      increase = 0.0;
+      fadePress = fadeSlow;
+      fadeRelease = fadeFast;
       break;
+#endif
 
     default: break;
   }
 }
 
+void setupKeyAnimation() {
+  getKeyAnimationFactors(keyAnimation, increaseFactor, fadeFactorPress, fadeFactorRelease);
+}
+
+void activateKeyData(KeyData& currentKey, uint8_t velocity, uint8_t whiteColor, uint8_t blackColor, float increase) {
+  currentKey.control |= 0x60; // pressing = true; refreshing = true
+
+  bool isBlackKey = (currentKey.control & 0x80) != 0;
+  bool randomColor = isBlackKey ? (blackColor == 0x40) : (whiteColor == 0x40);
+  if (randomColor) {
+    currentKey.control = (currentKey.control & 0xF0) | uint8_t(random(1, 10 + 1));
+  }
+
+  if (increase <= 0) {
+    currentKey.control |= 0x10; // peaked = true;
+    currentKey.alpha = getVelocityAlpha(velocity);
+  } else {
+    currentKey.control &= ~0x10; // peaked = false;
+    currentKey.alpha = 0;
+  }
+}
+
+void deactivateKey(KeyData& currentKey) {
+  currentKey.control &= ~0x20; // pressing = false
+  currentKey.control |= 0x10; // peaked = true;
+}
+
+void updateAlpha(KeyData& currentKey, float increase, float fadePress, float fadeRelease) {
+  bool pressing = ((currentKey.control & 0x20) != 0);
+  bool peaked = ((currentKey.control & 0x10) != 0);
+  if (pressing) { // pressing?
+    if (peaked) {
+      currentKey.alpha = uint8_t(float(currentKey.alpha) * fadePress);
+    } else {
+      float nextAlpha = (255.0 - float(currentKey.alpha)) * increase + float(currentKey.alpha) + 0.5;
+      if (nextAlpha > MAX_ALPHA) {
+        nextAlpha = MAX_ALPHA;
+      }
+      if (nextAlpha - float(currentKey.alpha) < 1.0) {
+        currentKey.control |= 0x10; // peaked = true
+      }
+      currentKey.alpha = uint8_t(nextAlpha);
+    }
+  } else {
+    currentKey.alpha = uint8_t(float(currentKey.alpha) * fadeRelease);
+  }
+  if (currentKey.alpha == 0) {
+    currentKey.control &= ~0x40; // refreshing = false
+  }
+}
+
 void updateKeyAlpha() {
   for (int i = 0; i < NUM_KEYS; ++i) {
     bool refreshing = ((keyData[i].control & 0x40) != 0);
     if (refreshing) {
-      bool pressing = ((keyData[i].control & 0x20) != 0);
-      bool peaked = ((keyData[i].control & 0x10) != 0);
-      if (pressing) { // pressing?
-        if (peaked) {
-          keyData[i].alpha = uint8_t(float(keyData[i].alpha) * fadeFactorPress);
-        } else {
-          float nextAlpha = (255.0 - float(keyData[i].alpha)) * increaseFactor + float(keyData[i].alpha) + 0.5;
-          if (nextAlpha > MAX_ALPHA) {
-            nextAlpha = MAX_ALPHA;
-          }
-          if (nextAlpha - float(keyData[i].alpha) < 1.0) {
-            keyData[i].control |= 0x10; // peaked = true
-          }
-          keyData[i].alpha = uint8_t(nextAlpha);
-        }
-      } else {
-        keyData[i].alpha = uint8_t(float(keyData[i].alpha) * fadeFactorRelease);
-      }
-      if (keyData[i].alpha == 0) {
-        keyData[i].control &= ~0x40; // refreshing = false
-      }
+      updateAlpha(keyData[i], increaseFactor, fadeFactorPress, fadeFactorRelease);
     }
   }
 }
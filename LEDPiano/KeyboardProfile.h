@@ -0,0 +1,87 @@
+#ifndef KEYBOARD_PROFILE_H
+#define KEYBOARD_PROFILE_H
+
+#include "LEDPianoTables.h"
+
+/*
+   Compile-time key / LED layout of a keyboard profile (see "Keyboard profile" in LEDPianoConfig.h)
+   Keys are spread evenly from the first to the last LED (same as /Misc/GenerateMidiTable.py),
+   all maps are constexpr, so they cost no SRAM or flash tables.
+   Setting keys: leftmost NUM_SETTING_KEYS keys, confirm key: rightmost key, slot keys: the NUM_SAVE_SLOTS keys before it.
+*/
+template <uint8_t keyNum, uint8_t startNote, uint8_t ledNum>
+struct KeyboardLayout {
+  static_assert(keyNum > NUM_SETTING_KEYS + NUM_SAVE_SLOTS + 1, "Too few keys for setting keys");
+  static_assert(uint16_t(startNote) + keyNum <= 128, "Keyboard exceeds MIDI range");
+  static_assert(ledNum >= keyNum, "NUM_LEDS should be at least NUM_KEYS");
+
+  static constexpr uint8_t keyLed(uint8_t keyIndex) {
+    return uint8_t((2 * uint16_t(keyIndex) * (ledNum - 1) + (keyNum - 1)) / (2 * (keyNum - 1))); // rounded
+  }
+
+  static constexpr uint8_t ledKey(uint8_t ledIndex) { // nearest key, inverse of keyLed()
+    return uint8_t((2 * uint16_t(ledIndex) * (keyNum - 1) + (ledNum - 1)) / (2 * (ledNum - 1)));
+  }
+
+  static constexpr uint8_t keyMidi(uint8_t keyIndex) {
+    return startNote + keyIndex;
+  }
+
+  static constexpr uint8_t midiKey(uint8_t midiCode) { // 0xFF: not on keyboard
+    return (midiCode >= startNote && midiCode < startNote + keyNum) ? midiCode - startNote : 0xFF;
+  }
+
+  static constexpr uint8_t confirmKey() {
+    return keyNum - 1;
+  }
+
+  static constexpr uint8_t slotKey(uint8_t slot) {
+    return keyNum - 1 - NUM_SAVE_SLOTS + slot;
+  }
+};
+
+typedef KeyboardLayout<NUM_KEYS, START_NOTE, NUM_LEDS> Keyboard;
+
+#ifdef KEY_TABLES
+#if TABLE_NUM_KEYS != NUM_KEYS || TABLE_START_NOTE != START_NOTE || TABLE_NUM_LEDS != NUM_LEDS
+#error "LEDPianoTables.h does not match your keyboard, please generate it by /Misc/GenerateMidiTable.py"
+#endif
+#endif
+
+inline uint8_t getKeyLed(uint8_t keyIndex) {
+#ifdef KEY_TABLES
+  return pgm_read_byte(&keyLedMap[keyIndex]);
+#else
+  return Keyboard::keyLed(keyIndex);
+#endif
+}
+
+inline uint8_t getLedKey(uint8_t ledIndex) {
+#ifdef KEY_TABLES
+  return pgm_read_byte(&ledKeyMap[ledIndex]);
+#else
+  return Keyboard::ledKey(ledIndex);
+#endif
+}
+
+inline uint8_t getKeyMidi(uint8_t keyIndex) {
+#ifdef KEY_TABLES
+  return pgm_read_byte(&keyMidiMap[keyIndex]);
+#else
+  return Keyboard::keyMidi(keyIndex);
+#endif
+}
+
+inline uint8_t getMidiKey(uint8_t midiCode) { // 0xFF: not on keyboard
+#ifdef KEY_TABLES
+  return midiCode < 128 ? pgm_read_byte(&midiKeyMap[midiCode]) : 0xFF;
+#else
+  return Keyboard::midiKey(midiCode);
+#endif
+}
+
+inline uint8_t getVelocityAlpha(uint8_t velocity) {
+  return pgm_read_byte(&velocityAlphaMap[velocity & 0x7F]);
+}
+
+#endif
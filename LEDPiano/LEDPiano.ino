@@ -6,48 +6,155 @@
 #include "SettingDisplay.h"
 #include "SettingControl.h"
 #include "ConfigStorage.h"
+#include "SysExControl.h"
+#include "CueControl.h"
+#include "FrameControl.h"
+#include "ProfileControl.h"
+#include "ParticleControl.h"
+#include "LayerControl.h"
+#include "CaptureControl.h"
+#include "StatsControl.h"
+#include "ReplayControl.h"
+#include "CoalesceControl.h"
+#include "BootControl.h"
+#include "ConnectionControl.h"
+
+void processMidi(uint8_t outBuf[]);
+#ifdef MIDI_COALESCE
+void applyCoalescedNotes();
+#endif
 
-void updateLeds() {
-  blendBgColors();
-  blendFgColors();
-  updateKeyAlpha();
+#ifdef LOOKAHEAD
+void processScheduledNotes() {
+  // Process notes scheduled before the frame is shown
+#ifdef RENDER_AHEAD
+  uint32_t showTime = millis() + 1000 / FPS;
+#else
+  uint32_t showTime = millis();
+#endif
+  uint8_t outBuf[4];
+  while (popScheduledNote(outBuf, showTime)) {
+    processMidi(outBuf);
+  }
+}
+#endif
+
+void renderFrame() {
+#ifdef LOOKAHEAD
+  processScheduledNotes();
+#endif
+#ifdef MIDI_COALESCE
+  applyCoalescedNotes();
+#endif
+  PROFILE_STAGE(PROFILE_BG, blendBgColors());
+#ifdef PARTICLE_EFFECT
+  renderParticles();
+#endif
+#ifdef MULTI_CHANNEL
+  PROFILE_STAGE(PROFILE_FG, blendFgColors(); blendLayerColors());
+  PROFILE_STAGE(PROFILE_KEY_ALPHA, updateKeyAlpha(); updateLayerAlpha());
+#else
+  PROFILE_STAGE(PROFILE_FG, blendFgColors());
+  PROFILE_STAGE(PROFILE_KEY_ALPHA, updateKeyAlpha());
+#endif
+  updateEnergy();
+#ifdef PARTICLE_EFFECT
+  updateParticles();
+#endif
   if (settingStatus) {
-    showConfigAll();
+    PROFILE_STAGE(PROFILE_CONFIG, showConfigAll());
+#ifdef SPARSE_BACKGROUND
+    invalidateBgCache(); // settings overlay is drawn over the background
+#endif
   }
-  FastLED.show();
+}
+
+void updateLeds() {
+#ifdef RENDER_AHEAD
+  PROFILE_STAGE(PROFILE_SHOW, showStrip()); // show the frame rendered in the previous tick
+  recordFrameInterval();
+#ifdef FRAME_CAPTURE
+  captureFrame();
+#endif
+  renderFrame(); // then render the next frame while waiting for the next tick
+#else
+  renderFrame();
+  PROFILE_STAGE(PROFILE_SHOW, showStrip());
+  recordFrameInterval();
+#ifdef FRAME_CAPTURE
+  captureFrame();
+#endif
+#endif
 }
 
 void activateKey(KeyData& currentKey, uint8_t velocity) {
-  currentKey.control |= 0x60; // pressing = true; refreshing = true
+  activateKeyData(currentKey, velocity, whiteKeyColor, blackKeyColor, increaseFactor);
+}
 
-  bool isBlackKey = (currentKey.control & 0x80) != 0;
-  bool randomColor = isBlackKey ? (blackKeyColor == 0x40) : (whiteKeyColor == 0x40);
-  if (randomColor) {
-    currentKey.control = (currentKey.control & 0xF0) | uint8_t(random(1, 10 + 1));
+void applyKeyPress(uint8_t keyIndex, uint8_t velocity) {
+  activateKey(keyData[keyIndex], velocity);
+#ifdef PARTICLE_EFFECT
+  spawnKeyParticles(keyIndex, velocity, getKeyColor(keyData[keyIndex], keyIndex, getKeyMidi(keyIndex)));
+#endif
+}
+
+#ifdef MIDI_COALESCE
+void applyCoalescedNotes() {
+  // Pending key events since the last frame, at most one activation per key
+  for (uint8_t n = 0; n < coalescedNoteNum; ++n) {
+    const CoalescedNote& pending = coalescedNotes[n];
+    KeyData& currentKey = keyData[pending.keyIndex];
+    if (pending.flags & COALESCE_PRESSED) {
+      applyKeyPress(pending.keyIndex, pending.velocity);
+    }
+    if (pending.flags & COALESCE_RELEASED) {
+      deactivateKey(currentKey);
+      if ((pending.flags & COALESCE_PRESSED) && currentKey.alpha < getVelocityAlpha(pending.velocity)) {
+        currentKey.alpha = getVelocityAlpha(pending.velocity); // tap: fade out from the peak, not from 0
+      }
+    }
   }
+  clearCoalescedNotes();
+}
 
-  if (increaseFactor <= 0) {
-    currentKey.control |= 0x10; // peaked = true;
-    currentKey.alpha = (velocity << 1) | 1;
-  } else {
-    currentKey.control &= ~0x10; // peaked = false;
-    currentKey.alpha = 0;
+void queueKeyNote(uint8_t keyIndex, uint8_t velocity) {
+  if (!coalesceNote(keyIndex, velocity)) {
+    applyCoalescedNotes(); // too many keys in one frame
+    coalesceNote(keyIndex, velocity);
+  }
+}
+#endif
+
+void pressKey(uint8_t keyIndex, uint8_t velocity) {
+#ifdef MIDI_COALESCE
+  if (settingStatus == 0) {
+    queueKeyNote(keyIndex, velocity);
+    return;
   }
+  applyCoalescedNotes(); // keep the order of events in setting mode
+#endif
+  applyKeyPress(keyIndex, velocity);
 }
 
-void deactivateKey(KeyData& currentKey) {
-  currentKey.control &= ~0x20; // pressing = false
-  currentKey.control |= 0x10; // peaked = true;
+void releaseKey(uint8_t keyIndex) {
+#ifdef MIDI_COALESCE
+  if (settingStatus == 0) {
+    queueKeyNote(keyIndex, 0);
+    return;
+  }
+  applyCoalescedNotes();
+#endif
+  deactivateKey(keyData[keyIndex]);
 }
 
 void settingControl(uint8_t keyIndex) {
-  if (keyIndex == settingKeys[0]) {
+  if (keyIndex == getSettingKey(0)) {
     prevStyle();
-  } else if (keyIndex == settingKeys[1]) {
+  } else if (keyIndex == getSettingKey(1)) {
     nextStyle();
-  } else if (keyIndex == settingKeys[2]) {
+  } else if (keyIndex == getSettingKey(2)) {
     prevSetting();
-  } else if (keyIndex == settingKeys[3]) {
+  } else if (keyIndex == getSettingKey(3)) {
     nextSetting();
   } else if (keyIndex == confirmKey) {
     saveCurrentConfig(configNum);
@@ -55,7 +162,7 @@ void settingControl(uint8_t keyIndex) {
     settingStatus = 0x00;
   } else {
     for (int i = 0; i < NUM_SAVE_SLOTS; ++i) {
-      if (keyIndex == slotKeys[i]) {
+      if (keyIndex == getSlotKey(i)) {
         switchToConfig(i);
         break;
       }
@@ -65,39 +172,71 @@ void settingControl(uint8_t keyIndex) {
 
 #ifdef DEBUG
 void debugPrintMidi(uint8_t outBuf[], uint16_t size) {
-  Serial.print("MIDI[");
+  Serial.print(F("MIDI["));
   Serial.print((size + 1));
-  Serial.print("] = [ ");
+  Serial.print(F("] = [ "));
   for (uint16_t i = 0; i <= size; ++i) { // MIDI message size, not buffer size
-    Serial.print("0x");
+    Serial.print(F("0x"));
     Serial.print(outBuf[i], HEX);
-    Serial.print(" ");
+    Serial.print(F(" "));
   }
-  Serial.println("]");
+  Serial.println(F("]"));
 }
 #endif
 
 void processMidi(uint8_t outBuf[]) {
   uint8_t statusCode = outBuf[1] & 0xF0;
+#ifdef PROFILE
+  ++midiEventCount;
+#endif
+#ifdef SYSEX_CONTROL
+  uint8_t codeIndex = outBuf[0] & 0x0F;
+  if (codeIndex >= 0x04 && codeIndex <= 0x07) { // SysEx packet
+    processSysEx(outBuf);
+    return;
+  }
+#endif
+#ifdef CUE_SEQUENCER
+  if (statusCode == 0xB0 || statusCode == 0xC0) { // Bank Select / Program Change
+    processCue(outBuf);
+    return;
+  }
+#endif
   if (statusCode == 0x80 || statusCode == 0x90) {
+#ifdef REPLAY_MODE
+    recordReplayNote(outBuf);
+#endif
     uint8_t pitch = outBuf[2] + MIDI_OFFSET;
     uint8_t velocity = outBuf[3];
-    if (statusCode == 0x80 || velocity == 0) { // 0x80 note off
-      for (uint8_t i = 0; i < NUM_KEYS; ++i) {
-        if (keyMidiMap[i] == pitch) {
-          deactivateKey(keyData[i]);
-          break;
-        }
+    uint8_t i = getMidiKey(pitch);
+    if (i == 0xFF) {
+      return; // not on keyboard
+    }
+#ifdef MULTI_CHANNEL
+    uint8_t layerIndex = getLayerIndex(outBuf[1] & 0x0F);
+    if (layerIndex != 0xFF) { // note of a key layer
+      if (statusCode == 0x80 || velocity == 0) {
+        deactivateLayerKey(layerIndex, i);
+      } else {
+        activateLayerKey(layerIndex, i, velocity);
+        addNoteEnergy(i, velocity);
+#ifdef SESSION_STATS
+        recordNoteStats(i, velocity);
+#endif
       }
+      return;
+    }
+#endif
+    if (statusCode == 0x80 || velocity == 0) { // 0x80 note off
+      releaseKey(i);
     } else { // 0x90 note on
-      for (uint8_t i = 0; i < NUM_KEYS; ++i) {
-        if (keyMidiMap[i] == pitch) {
-          activateKey(keyData[i], velocity);
-          if (settingStatus) {
-            settingControl(i);
-          }
-          break;
-        }
+      pressKey(i, velocity);
+      addNoteEnergy(i, velocity);
+#ifdef SESSION_STATS
+      recordNoteStats(i, velocity);
+#endif
+      if (settingStatus) {
+        settingControl(i);
       }
     }
   }
@@ -110,7 +249,7 @@ void midiInputCheck() {
   midiEventPacket_t event;
 #endif
   do {
-    if ( (size = Midi.RecvRawData(outBuf)) > 0 ) {
+    if ( (size = receiveMidi(outBuf)) > 0 ) {
 
 #ifdef PIANO_TO_COMPUTER
       // Send MIDI packet from instrument to computer (host)
@@ -140,9 +279,15 @@ void midiInputCheck() {
       outBuf[3] = event.byte3;
 
 #ifdef COMPUTER_TO_PIANO
-      Midi.SendRawData(4, outBuf); // send MIDI data to instrument
+      sendMidi(outBuf); // send MIDI data to instrument
 #endif
 
+#ifdef LOOKAHEAD
+      uint8_t statusCode = outBuf[1] & 0xF0;
+      if ((statusCode == 0x80 || statusCode == 0x90) && isLookaheadActive()) {
+        continue; // notes are lit by schedule
+      }
+#endif
       processMidi(outBuf);
     }
   } while (event.header != 0);
@@ -168,25 +313,54 @@ void showError() {
     }
     frameCountSetting = 0;
   }
-  FastLED.show();
+#ifdef SPARSE_BACKGROUND
+  invalidateBgCache();
+#endif
+  showStrip();
 }
 
 Ticker ledTimer(updateLeds, 1000 / FPS);
 Ticker errorFlashTimer(showError, 500);
 
+void startStyle() {
+  // Show the style instead of the error flash
+#ifdef RENDER_AHEAD
+  renderFrame(); // leds still holds the error flash, render the first frame now
+#endif
+  resetFrameInterval();
+  ledTimer.start();
+  errorFlashTimer.stop();
+}
+
+void startErrorFlash() {
+  ledTimer.stop();
+  errorFlashTimer.start();
+}
+
 void midiCheckLoop() {
-  Usb.Task();
+  PROFILE_STAGE(PROFILE_USB, midiHostTask());
   uint8_t codeHeader = systemStatus & 0xF0;
 
-  if (Midi) {
+  bool midiActive = isMidiConnected();
+#ifdef REPLAY_MODE
+  midiActive = midiActive || isReplayPlaying(); // playback runs without instrument
+#endif
+
+  if (midiActive) {
     midiInputCheck();
     if (codeHeader != 0x30) { // previously not main or setting status
       systemStatus = (systemStatus & 0x0F) | 0x30;
-      ledTimer.start();
-      errorFlashTimer.stop();
+      startStyle();
+#ifdef FAST_BOOT
+      recordMidiConnect();
+#endif
+      recordMidiFound();
 
 #ifdef DEBUG
-      Serial.println("MIDI connected");
+      Serial.println(F("MIDI connected"));
+      if (reconnectCount) {
+        printConnectionState();
+      }
 #endif
     }
 
@@ -202,54 +376,195 @@ void midiCheckLoop() {
 
     if (codeHeader == 0x30) { // previously main or setting status
       systemStatus = (systemStatus & 0x0F) | 0x20; // seeking midi
-      ledTimer.stop();
-      errorFlashTimer.start();
+      releaseAllKeys(); // note off of held keys is lost with the instrument
+      recordMidiLost(); // ledTimer keeps running while reconnecting, see loop()
 
 #ifdef DEBUG
-      Serial.println("MIDI disconnected");
+      Serial.println(F("MIDI disconnected"));
 #endif
     }
   }
 }
 
-void setup() {
-  systemStatus = 0x10; // system start up
-  FastLED.addLeds<WS2812B, STRIP_PIN, GRB>(leds, NUM_LEDS); // Remider: here RGB order is "GRB" for WS2812B
-  initKeys();
-
-#ifdef DEBUG
-  Serial.begin(115200);
+#ifdef REPLAY_MODE
+void playReplay() {
+  uint8_t outBuf[4];
+  while (popReplayNote(outBuf)) {
+    processMidi(outBuf);
+  }
+}
 #endif
 
-  errorFlashTimer.start();
-  if (Usb.Init() == -1) {
-    systemStatus = 0x40; // usb error
-    while (1) {
-      errorFlashTimer.update();
+#ifdef SERIAL_COMMAND
+void checkSerialCommand() {
+  // One character commands, any line ending
+  while (Serial.available() > 0) {
+    switch (Serial.read()) {
+#ifdef PROFILE
+      case 'p': printProfile(); break;
+      case 'r': resetProfile(); Serial.println(F("reset")); break;
+#endif
+#ifdef SESSION_STATS
+      case 's': printStats(); break;
+      case 'c': resetStats(); Serial.println(F("cleared")); break;
+#endif
+#ifdef REPLAY_MODE
+      case 'R': stopReplay(); startRecording(); printReplayState(); break;
+      case 'L': stopReplay(); startPlayback(); printReplayState(); break;
+      case 'X': stopReplay(); printReplayState(); break;
+      case 'W': saveReplay(); Serial.println(F("saved")); break;
+#endif
+#ifdef FAST_BOOT
+      case 'b': printBootTimes(); break;
+#endif
+      case 'u': printConnectionState(); break;
+      case 'h':
+#ifdef PROFILE
+        Serial.println(F("p: print report, r: reset counters"));
+#endif
+#ifdef SESSION_STATS
+        Serial.println(F("s: print statistics, c: clear statistics"));
+#endif
+#ifdef REPLAY_MODE
+        Serial.println(F("R: record, L: loop playback, X: stop, W: write recording to EEPROM"));
+#endif
+#ifdef FAST_BOOT
+        Serial.println(F("b: print boot times"));
+#endif
+        Serial.println(F("u: print USB connection state"));
+        break;
+      default: break;
     }
   }
+}
+#endif
 
-  systemStatus = 0x20; // seeking midi
-
+void loadStartupStyle() {
 #ifndef TEST_STYLE
   settingStatus = 0x10;
   checkSavedConfig();
+#ifdef REPLAY_MODE
+  loadReplay();
+#ifdef REPLAY_AUTOPLAY
+  startPlayback(); // leaves setting mode
+#endif
+#endif
 #else
   // will start up as the style you preset if TEST_STYLE is defined
   settingStatus = 0x00;
 #endif
 }
 
+void setup() {
+  systemStatus = 0x10; // system start up
+  initStrip();
+  initKeys();
+#ifdef MULTI_CHANNEL
+  initLayers();
+#endif
+
+#if defined(FRAME_CAPTURE)
+  Serial.begin(CAPTURE_BAUD);
+#elif defined(DEBUG) || defined(SERIAL_COMMAND)
+  Serial.begin(115200);
+#endif
+
+#ifdef FAST_BOOT
+  loadStartupStyle(); // show the saved style before USB host is initialized
+  renderFrame();
+  showStrip();
+  recordFirstFrame();
+  ledTimer.start();
+#else
+  errorFlashTimer.start();
+#endif
+  if (initMidiHost()) {
+    systemStatus = 0x20; // seeking midi
+#ifdef FAST_BOOT
+    recordMidiHostReady();
+#endif
+  } else {
+    systemStatus = 0x40; // usb error, retried in loop()
+    scheduleMidiHostRetry();
+    startErrorFlash();
+  }
+#ifdef FAST_BOOT
+#ifdef DEBUG
+  printBootTimes();
+#endif
+#else
+  loadStartupStyle();
+#endif
+}
+
+bool isSeekingWithStyle() {
+  // Show the style instead of the MIDI warning flash
+#ifdef FAST_BOOT
+  if (isBootSeeking()) {
+    return true;
+  }
+#endif
+  return isReconnecting();
+}
+
 void loop() {
+#ifdef SERIAL_COMMAND
+  checkSerialCommand();
+#endif
   uint8_t codeHeader = systemStatus & 0xF0;
   switch (codeHeader) {
     case 0x30: // main or setting
       midiCheckLoop();
+#ifdef REPLAY_MODE
+      playReplay();
+#endif
       ledTimer.update();
+#ifdef CUE_SEQUENCER
+      updateCueStage();
+#endif
       break;
     case 0x20: // seeking midi
       midiCheckLoop();
+      if ((systemStatus & 0xF0) != 0x20) {
+        break; // connected
+      }
+      if (isSeekingWithStyle()) {
+        if (ledTimer.state() != RUNNING) { // USB host ready after an error, boot seek time not over
+          startStyle();
+        }
+        ledTimer.update(); // keep showing the style while the instrument enumerates
+        break;
+      }
+      if (ledTimer.state() == RUNNING) { // no instrument in time
+        startErrorFlash();
+      }
       errorFlashTimer.update();
+      break;
+    case 0x40: // usb error
+      if (retryMidiHost()) {
+        systemStatus = (systemStatus & 0x0F) | 0x20; // seeking midi
+#ifdef FAST_BOOT
+        recordMidiHostReady();
+#endif
+#ifdef DEBUG
+        Serial.println(F("USB host ready"));
+#endif
+      }
+#ifdef REPLAY_MODE
+      if (isReplayPlaying()) { // playback runs without USB host
+        if (ledTimer.state() != RUNNING) {
+          startStyle();
+        }
+        playReplay();
+        ledTimer.update();
+        break;
+      }
+      if (ledTimer.state() == RUNNING) { // playback stopped
+        startErrorFlash();
+      }
+#endif
+      errorFlashTimer.update();
+      break;
     default:
       break;
   }
@@ -2,7 +2,7 @@
    by @Fanseline, 20220625
 
    Hardware:
-     1. Arduino UNO R3 / Leonardo R3
+     1. Arduino UNO R3 / Leonardo R3 (or RP2040 boards, USB host runs on the second core, see PlatformControl.h)
      2. USB Host Shield 2.0:
         Hardware manual: https://chome.nerpa.tech/usb-host-shield-hardware-manual/
         Soldered as: https://chome.nerpa.tech/wp/wp-content/uploads/2011/02/uhs20s_pin_layout.jpg
@@ -20,6 +20,26 @@
 
 // #define DEBUG // Print MIDI packet via serial
 // #define TEST_STYLE // Test default style
+// #define PROFILE // Profile hot path via serial command, see ProfileControl.h
+
+/* Render mode
+   Default (render on tick): each tick renders the frame, then shows it.
+     Lowest latency, but the time of FastLED.show() moves with the render cost.
+   RENDER_AHEAD: each tick shows the frame rendered in the previous tick, then renders the next one.
+     FastLED.show() always happens right on the tick (less jitter), but adds one frame of latency.
+   Frame jitter is printed via serial when DEBUG is defined.
+*/
+// #define RENDER_AHEAD
+
+/* Frame capture
+   FRAME_CAPTURE: stream every shown frame via serial (RLE encoded, unchanged frames are skipped)
+   Record and decode it with /Misc/LEDFrameCapture.py, e.g. for visual regression tests
+   DEBUG messages can be mixed in, they will be skipped by the decoder
+*/
+// #define FRAME_CAPTURE
+#define CAPTURE_BAUD 1000000 // 115200 is only enough for static styles
+#define CAPTURE_FRAME_DIVIDER 1 // capture one in every N frames
+#define CAPTURE_KEYFRAME_INTERVAL 60 // max repeat records in a row (1 - 255), then a full frame is sent again
 
 /* Leonardo R3 (MEGA32U4) can use the following two features: PIANO_TO_COMPUTER & COMPUTER_TO_PIANO
    However, loop MIDI to your computer or digital piano may lead to latency issue
@@ -33,9 +53,7 @@
 
 #include "Ticker.h"
 #include <FastLED.h>
-#include <usbh_midi.h>
-#include <usbhub.h>
-#include <EEPROM.h>
+#include "ProgmemData.h" // readProgmem(): read-only tables are kept in flash
 
 #ifdef PIANO_TO_COMPUTER
 #include "MIDIUSB.h"
@@ -43,15 +61,76 @@
 
 /* ****************** Static Configurations ****************** */
 
-#define NUM_LEDS 175 // Number of LEDs on your strip, max = 180
+/*
+   Keyboard profile
+   Select your keyboard, or comment out all of them and define NUM_KEYS, START_NOTE, NUM_LEDS & PIANO_WIDTH_MM yourself.
+   Key / LED maps and setting keys are derived from the profile at compile time (see KeyboardProfile.h),
+   KEY_TABLES: use keyLedMap[], ledKeyMap[], keyMidiMap[] & midiKeyMap[] in LEDPianoTables.h instead (custom layout),
+   generate them for your keyboard by /Misc/GenerateMidiTable.py.
+*/
+#define KEYBOARD_88
+// #define KEYBOARD_76
+// #define KEYBOARD_61
+// #define KEYBOARD_49
+// #define KEY_TABLES
+
+#if defined(KEYBOARD_88)
 #define NUM_KEYS 88
+#define START_NOTE 21 // A0, leftmost key on your midi keyboard
+#define NUM_LEDS 175 // Number of LEDs on your strip, max = 180
+#define PIANO_WIDTH_MM 1215 // Strip length over the keyboard (KEY_SPAN_MAPPING), 175 LEDs at 144 LEDs/m
+#elif defined(KEYBOARD_76)
+#define NUM_KEYS 76
+#define START_NOTE 28 // E0
+#define NUM_LEDS 151
+#define PIANO_WIDTH_MM 1049
+#elif defined(KEYBOARD_61)
+#define NUM_KEYS 61
+#define START_NOTE 36 // C2
+#define NUM_LEDS 121
+#define PIANO_WIDTH_MM 840
+#elif defined(KEYBOARD_49)
+#define NUM_KEYS 49
+#define START_NOTE 36 // C2
+#define NUM_LEDS 97
+#define PIANO_WIDTH_MM 674
+#endif
 
 #define STRIP_PIN A0
 // #define STRIP_CLOCK A1 // Please check FastLED library
 
-#define START_NOTE 21 // A0, leftmost key on your midi keyboard
 #define MIDI_OFFSET 0
 
+/*
+   USB host connection (see ConnectionControl.h)
+   If the USB Host Shield fails to initialize, the error flash is shown and init is tried again,
+   first after USB_RETRY_MIN_TIME, the wait is doubled after each failure up to USB_RETRY_MAX_TIME.
+   When the instrument is unplugged, its held keys are released and the style keeps running
+   for MIDI_RECONNECT_TIME while it is enumerated again, then the MIDI warning flash is shown until it is back.
+   Reconnect times are printed with DEBUG, and by serial command u if the serial shell is on.
+*/
+#define USB_RETRY_MIN_TIME 250 // ms
+#define USB_RETRY_MAX_TIME 8000 // ms
+#define MIDI_RECONNECT_TIME 10000 // ms
+
+/*
+   Gamma correction
+   GAMMA_CORRECTION: key alpha is treated as perceived brightness and converted to a linear blending weight
+   by gammaTable[] in LEDPianoTables.h, so key fading looks smooth and even.
+   Brightness codes (0x?0 - 0x?F) are not corrected, FastLED's HSV conversion already squares the value (about gamma 2).
+   Off by default until checked on a real strip.
+*/
+// #define GAMMA_CORRECTION
+
+/*
+   Sparse background rendering
+   SPARSE_BACKGROUND: for static background animation (0x00, 0x01), the background is rendered once and kept in leds[],
+   each frame only restores the LEDs drawn by keys (or particles) in the previous frame, tracked by a bit mask.
+   The whole background is rendered again when the background config changes, during style transition & settings.
+   Uses (NUM_LEDS + 7) / 8 + 8 bytes of SRAM, comment out to render all LEDs every frame.
+*/
+#define SPARSE_BACKGROUND
+
 /*
    Brightness limit (power limit)
    Consider external power supply for LED strip.
@@ -70,8 +149,96 @@
 #define NUM_SAVE_SLOTS 5
 #define NUM_SETTING_KEYS 4 // Leftmost 4 keys for setting
 
+/* Live config upload via MIDI SysEx (see SysExControl.h, host side: /Misc/LEDPianoSysEx.py)
+   SYSEX_CONFIG: keeps a validated copy of all slots in SRAM (CONFIG_SIZE * NUM_SAVE_SLOTS bytes),
+   uploaded configs are applied immediately and only written to EEPROM by the commit command.
+*/
+// #define SYSEX_CONFIG
+
+/* Cue sequencer (see CueControl.h)
+   CUE_SEQUENCER: MIDI Program Change (with optional Bank Select MSB) on CUE_CHANNEL switches to the slot in cueList[],
+   all slots are kept validated in SRAM like SYSEX_CONFIG, the next cue is staged in idle time (no EEPROM access on cue).
+   Notice: many digital pianos send Program Change when you change the instrument voice, use CUE_CHANNEL to filter them.
+*/
+// #define CUE_SEQUENCER
+#define CUE_CHANNEL 0xFF // MIDI channel of cue changes (0x00 - 0x0F), 0xFF: any channel
+
+/* Style transition
+   STYLE_TRANSITION: cross-fade the background from the old style to the new one when style or config slot is changed,
+   the old style is rendered only during the transition (STYLE_TRANSITION_FRAMES frames), it costs 8 bytes of SRAM.
+*/
+// #define STYLE_TRANSITION
+#define STYLE_TRANSITION_FRAMES 30 // 0.5s at 60 FPS, max 255
+
+/* Look-ahead playback (see LookaheadControl.h, host side: /Misc/LEDPianoLookahead.py)
+   LOOKAHEAD: notes sent ahead of time from computer are lit exactly on their scheduled frame (PIANO_TO_COMPUTER only),
+   uses 7 * LOOKAHEAD_QUEUE_SIZE bytes of SRAM.
+*/
+// #define LOOKAHEAD
+#define LOOKAHEAD_QUEUE_SIZE 24
+#define LOOKAHEAD_HOLD_TIME 2000 // ms, ignore live notes from computer until this long after the last scheduled note
+
+/* Session statistics (see StatsControl.h)
+   SESSION_STATS: counts note on events per key, per velocity range and per second (last STATS_RATE_SECONDS seconds),
+   adds background animation 0x40 (heatmap of the most played keys, brightness from idle to activated SV,
+   a gradient color runs from its start hue to its stop hue). Uses 2 * NUM_KEYS + STATS_RATE_SECONDS + 34 bytes of SRAM.
+   Serial commands: s: print statistics, c: clear statistics
+*/
+// #define SESSION_STATS
+#define STATS_RATE_SECONDS 30 // notes per second history, max 255
+
+/* Replay mode (see ReplayControl.h)
+   REPLAY_MODE: records note on / off events into a ring buffer (3 * REPLAY_EVENT_NUM bytes of SRAM)
+   and loops them through the same path as notes from the instrument, e.g. for demos or soak tests with PROFILE.
+   The recording can be saved to EEPROM (after the config slots) and is loaded at boot.
+   Serial commands: R: record, L: loop playback, X: stop, W: write recording to EEPROM
+   REPLAY_AUTOPLAY: play the saved recording at boot, the LEDs run without instrument.
+*/
+// #define REPLAY_MODE
+// #define REPLAY_AUTOPLAY
+#define REPLAY_EVENT_NUM 64 // max 255, also limited by EEPROM size (UNO: 1KB)
+#define REPLAY_TICK 4 // ms, time resolution of recording
+#define REPLAY_LOOP_GAP 2000 // ms, pause before the recording starts over
+
+/* MIDI event coalescing (see CoalesceControl.h)
+   MIDI_COALESCE: note on / off events are merged per key until the next frame, so each key is activated at most
+   once per frame (highest velocity), and a key pressed and released within one frame still flashes.
+   Bounds per-frame work (random colors, particles) under MIDI floods, e.g. fast repeated notes or USB Host & MIDIUSB input together.
+   Not used in setting mode or for MULTI_CHANNEL layers. Uses 3 * COALESCE_SIZE + 1 bytes of SRAM.
+*/
+// #define MIDI_COALESCE
+#define COALESCE_SIZE 16 // keys with pending events, all are applied early when full
+
+/* Fast boot (see BootControl.h)
+   FAST_BOOT: the saved style is loaded and its first frame is shown before the USB host is initialized,
+   the style keeps running while the instrument enumerates, the MIDI warning flash only starts after BOOT_SEEK_TIME.
+   Each config slot gets a checksum in EEPROM (NUM_SAVE_SLOTS + 1 bytes after the slots), slots with a matching checksum
+   skip the value list searches at boot (brightness limits are always checked),
+   a slot torn by power loss while saving fails the checksum and is validated as before.
+   Time to the first frame & to MIDI connected are printed with DEBUG, and by serial command b if the serial shell is on
+   (PROFILE, SESSION_STATS or REPLAY_MODE).
+*/
+// #define FAST_BOOT
+#define BOOT_SEEK_TIME 10000 // ms after boot, show the style instead of the MIDI warning until then
+
+#if defined(SYSEX_CONFIG) || defined(CUE_SEQUENCER)
+#define CONFIG_CACHE
+#endif
+
+#if defined(SYSEX_CONFIG) || defined(LOOKAHEAD)
+#define SYSEX_CONTROL
+#endif
+
+#if defined(PROFILE) || defined(SESSION_STATS) || defined(REPLAY_MODE)
+#define SERIAL_COMMAND
+#endif
+
+#if defined(LOOKAHEAD) && !defined(PIANO_TO_COMPUTER)
+#error "LOOKAHEAD needs PIANO_TO_COMPUTER"
+#endif
+
 const static uint8_t projectTitleLength = 16;
-const static char projectTitle[projectTitleLength + 1] = "FanLEDPiano V003"; // Modify title will reset EEPROM!
+const static char projectTitle[projectTitleLength + 1] PROGMEM = "FanLEDPiano V003"; // Modify title will reset EEPROM!
 
 /*
    MIDI keyboard - LED mapping (LED number starts from left)
@@ -89,17 +256,26 @@ const static char projectTitle[projectTitleLength + 1] = "FanLEDPiano V003"; //
    |   |   |   |   |   |   |   |   |   |           |   |   |   |   |   |   |   |   |
    |___|___|___|___|___|___|___|___|___|           |___|___|___|___|___|___|___|___|
 */
-const static uint8_t keyLedMap[NUM_KEYS] =
-{ 0, 2, 4, // A0 -> B0
-  6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, // C1 -> B1
-  30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, // C2 -> B2
-  54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, // C3 -> B3
-  78, 80, 82, 84, 86, 88, 90, 92, 94, 96, 98, 100, // C4 -> B4
-  102, 104, 106, 108, 110, 112, 114, 116, 118, 120, 122, 124, // C5 -> B5
-  126, 128, 130, 132, 134, 136, 138, 140, 142, 144, 146, 148, // C6 -> B6
-  150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, // C7 -> B7
-  174 // C8
-};
+#include "KeyboardProfile.h" // getKeyLed(), getKeyMidi(), getMidiKey() ... (see also LEDPianoTables.h)
+
+/*
+   Anti-aliased key span mapping (optional, uses 4 * NUM_KEYS bytes of SRAM)
+   KEY_SPAN_MAPPING: instead of one LED by getKeyLed(), each key covers a fractional span of the strip:
+     span width = PIANO_WIDTH_MM / NUM_KEYS, converted to LEDs by LEDS_PER_METER
+   Coverage weights of the LEDs under each span are calculated once at boot (initKeySpans()),
+   key highlights are then blended into all covered LEDs with partial LEDs dimmed by their weight.
+
+   |<-------- key 0 -------->|<-------- key 1 -------->|
+   [ LED0 ][ LED1 ][ LED2 ][ LED3 ][ LED4 ]
+     100%    100%    15%     85%     100%  ...
+*/
+// #define KEY_SPAN_MAPPING
+#define LEDS_PER_METER 144
+#define KEY_SPAN_MAX_LEDS 3 // Max LEDs covered by one key
+
+#if (PIANO_WIDTH_MM * LEDS_PER_METER) / (NUM_KEYS * 1000) + 2 > KEY_SPAN_MAX_LEDS
+#error "Key span is wider than KEY_SPAN_MAX_LEDS, please increase KEY_SPAN_MAX_LEDS"
+#endif
 
 /*
       MIDI code vs piano keys (A4 = 440Hz)
@@ -119,17 +295,7 @@ const static uint8_t keyLedMap[NUM_KEYS] =
    22         0x16      2          A#/Bb0     29.14
    21         0x15      1          A0         27.50
 */
-const static uint8_t keyMidiMap[NUM_KEYS] =
-{ 21, 22, 23, // A0 -> B0
-  24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, // C1 -> B1
-  36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, // C2 -> B2
-  48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, // C3 -> B3
-  60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, // C4 -> B4
-  72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, // C5 -> B5
-  84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, // C6 -> B6
-  96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, // C7 -> B7
-  108 // C8
-};
+// getKeyMidi() & getMidiKey(): see KeyboardProfile.h
 
 /* Setting Demo LEDs config
    settingLedLeft: show which stytle is under adjusting
@@ -143,8 +309,8 @@ const static uint8_t settingLedLeftStart = 0;
 const static uint8_t settingLedLeftEnd = 7;
 const static uint8_t styleNumLedStart = 8;
 const static uint8_t styleNumLedEnd = 15;
-const static uint8_t settingLedRightStart = 163;
-const static uint8_t settingLedRightEnd = 174;
+const static uint8_t settingLedRightStart = Keyboard::keyLed(Keyboard::slotKey(0)) - 1; // 163 (88 keys)
+const static uint8_t settingLedRightEnd = NUM_LEDS - 1;
 
 /*
    Setting configuration on MIDI keyboard
@@ -168,31 +334,83 @@ const static uint8_t settingLedRightEnd = 174;
                                                                   slot4(B7)__|   |
                                                                                  |
                                                            confirm & save(C8)____|
+   (88 keys shown, slot keys & confirm key are always the rightmost keys of your keyboard)
 */
-const static uint8_t slotKeys[NUM_SAVE_SLOTS] = {82, 83, 84, 85, 86}; // from G7 to B7, index of keyData[]: slot0 - slot4
-const static uint8_t settingKeys[NUM_SETTING_KEYS] = {0, 1, 2, 3}; // from A0 to C1, index of keyData[]: prevStyle, nextStyle, prevSetting, nextSetting
-const static uint8_t confirmKey = 87; // C8, index of keyData[]
-
-const static uint8_t bgAnimationNum = 13;
-const static uint8_t bgAnimationList[bgAnimationNum] =
+const static uint8_t slotKeys[NUM_SAVE_SLOTS] PROGMEM = // from G7 to B7 (88 keys), index of keyData[]: slot0 - slot4
+{Keyboard::slotKey(0), Keyboard::slotKey(1), Keyboard::slotKey(2), Keyboard::slotKey(3), Keyboard::slotKey(4)};
+const static uint8_t settingKeys[NUM_SETTING_KEYS] PROGMEM = {0, 1, 2, 3}; // from A0 to C1 (88 keys), index of keyData[]: prevStyle, nextStyle, prevSetting, nextSetting
+const static uint8_t confirmKey = Keyboard::confirmKey(); // C8 (88 keys), index of keyData[]
+
+inline uint8_t getSlotKey(uint8_t slot) {
+  return readProgmem(&slotKeys[slot]);
+}
+
+inline uint8_t getSettingKey(uint8_t index) {
+  return readProgmem(&settingKeys[index]);
+}
+
+#ifdef SESSION_STATS
+const static uint8_t bgAnimationNum = 17;
+const static uint8_t bgAnimationList[bgAnimationNum] PROGMEM =
 { 0x00, 0x01,
   0x10, 0x11, 0x12, 0x13, 0x14,
-  0x20, 0x21, 0x22, 0x23, 0x24, 0x25
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25,
+  0x30, 0x31, 0x32,
+  0x40
 }; // List for blendFgColors()
+#else
+const static uint8_t bgAnimationNum = 16;
+const static uint8_t bgAnimationList[bgAnimationNum] PROGMEM =
+{ 0x00, 0x01,
+  0x10, 0x11, 0x12, 0x13, 0x14,
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25,
+  0x30, 0x31, 0x32
+}; // List for blendFgColors()
+#endif
 
+/*
+   Particle effects (optional, uses 10 * PARTICLE_POOL_SIZE bytes of SRAM)
+   PARTICLE_EFFECT: adds key animation 10 (ripple) and 11 (sparks) to keyAnimationList[]
+*/
+// #define PARTICLE_EFFECT
+#define PARTICLE_POOL_SIZE 16
+
+#ifdef PARTICLE_EFFECT
+const static uint8_t keyAnimationNum = 12;
+const static uint8_t keyAnimationList[keyAnimationNum] PROGMEM =
+{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}; // List for updateKeyAnimation()
+#else
 const static uint8_t keyAnimationNum = 10;
-const static uint8_t keyAnimationList[keyAnimationNum] =
+const static uint8_t keyAnimationList[keyAnimationNum] PROGMEM =
 {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}; // List for updateKeyAnimation()
+#endif
+
+/*
+   Multi-channel key layers (optional, see LayerControl.h)
+   MULTI_CHANNEL: notes on the MIDI channel of a layer use the key animation & colors of that layer (e.g. split or layered sounds),
+   notes on other channels use the current style. Uses (22 + 3 * LAYER_MAX_KEYS) bytes of SRAM per layer.
+*/
+// #define MULTI_CHANNEL
+#define LAYER_NUM 1
+#define LAYER_MAX_KEYS 16 // max active (lit) keys of each layer
+
+#ifdef MULTI_CHANNEL
+const static uint8_t layerConfig[LAYER_NUM][6] PROGMEM =
+{
+  /* Data order for each row: MIDI channel (0x00 - 0x0F), keyAnimation, whiteKeyColor, whiteKeySV, blackKeyColor, blackKeySV */
+  {0x01, 0x01, 0x08, 0xAF, 0x08, 0xAF}, // channel 2: blue
+};
+#endif
 
 const static uint8_t bgColorNum = 27;
-const static uint8_t bgColorList[bgColorNum] =
+const static uint8_t bgColorList[bgColorNum] PROGMEM =
 { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, // Pure color
   0x80 | 0, 0x80 | 1, 0x80 | 2, 0x80 | 3, 0x80 | 4, 0x80 | 5, 0x80 | 6, 0x80 | 7, // Gradient one cycle
   0xE0 | 0, 0xE0 | 1, 0xE0 | 2, 0xE0 | 3, 0xE0 | 4, 0xE0 | 5, 0xE0 | 6, 0xE0 | 7, // Gradient multi-cycle
 }; // List for getColorByCode()
 
 const static uint8_t keyColorNum = 28;
-const static uint8_t keyColorList[keyColorNum] =
+const static uint8_t keyColorList[keyColorNum] PROGMEM =
 { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, // Pure color
   0x80 | 0, 0x80 | 1, 0x80 | 2, 0x80 | 3, 0x80 | 4, 0x80 | 5, 0x80 | 6, 0x80 | 7, // Gradient one cycle
   0xE0 | 0, 0xE0 | 1, 0xE0 | 2, 0xE0 | 3, 0xE0 | 4, 0xE0 | 5, 0xE0 | 6, 0xE0 | 7, // Gradient multi-cycle
@@ -206,7 +424,7 @@ const static uint8_t bgVActivatedOffset = 0x0A;
 const static uint8_t keySOffset = 0x0F;
 const static uint8_t keyVOffset = 0x0F;
 
-const static uint8_t defaultConfig[NUM_SAVE_SLOTS][CONFIG_SIZE] =
+const static uint8_t defaultConfig[NUM_SAVE_SLOTS][CONFIG_SIZE] PROGMEM =
 {
   /* Data order for each row:
     0.bgAnimation
@@ -227,6 +445,19 @@ const static uint8_t defaultConfig[NUM_SAVE_SLOTS][CONFIG_SIZE] =
   {0x23, 0xE0, 0x92, 0xE4, 0xB5, 0x08, 0x40, 0xFF, 0x40, 0xFF},
 };
 
+#ifdef CUE_SEQUENCER
+const static uint8_t cueNum = 5;
+const static uint8_t cueList[cueNum][3] PROGMEM =
+{
+  /* Cues in show order: bank (Bank Select MSB), program (Program Change), config slot */
+  {0x00, 0x00, 0},
+  {0x00, 0x01, 1},
+  {0x00, 0x02, 2},
+  {0x00, 0x03, 3},
+  {0x00, 0x04, 4},
+};
+#endif
+
 
 /* ****************** Global Variables ****************** */
 
@@ -264,8 +495,8 @@ float fadeFactorPress = 0.97;
 float fadeFactorRelease = 0.3;
 
 CRGBArray<NUM_LEDS> leds;
-USB Usb;
-USBH_MIDI Midi(&Usb);
+
+#include "PlatformControl.h" // LED strip, USB host & storage of the board (AVR / RP2040 / host build)
 
 struct KeyData {
   uint8_t alpha;
@@ -275,4 +506,12 @@ struct KeyData {
 };
 KeyData keyData[NUM_KEYS];
 
+#ifdef KEY_SPAN_MAPPING
+struct KeySpan {
+  uint8_t startLed; // first LED covered by the key
+  uint8_t weight[KEY_SPAN_MAX_LEDS]; // coverage of startLed, startLed + 1, ... (0x00 - 0xFF), 0 ends the span
+};
+KeySpan keySpan[NUM_KEYS];
+#endif
+
 #endif
@@ -0,0 +1,136 @@
+/* Generated by /Misc/GenerateMidiTable.py, do not edit
+   python GenerateMidiTable.py --header LEDPianoTables.h --num-keys 88 --start-note 21 --num-leds 175 --velocity-curve 1.0 --gamma 2.2
+*/
+
+#ifndef LED_PIANO_TABLES_H
+#define LED_PIANO_TABLES_H
+
+#include <avr/pgmspace.h>
+
+#define TABLE_NUM_KEYS 88
+#define TABLE_START_NOTE 21
+#define TABLE_NUM_LEDS 175
+
+// LED number of each key (index of keyData[])
+const uint8_t keyLedMap[TABLE_NUM_KEYS] PROGMEM =
+{
+  0, 2, 4, // A0 -> B0
+  6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, // C1 -> B1
+  30, 32, 34, 36, 38, 40, 42, 44, 46, 48, 50, 52, // C2 -> B2
+  54, 56, 58, 60, 62, 64, 66, 68, 70, 72, 74, 76, // C3 -> B3
+  78, 80, 82, 84, 86, 88, 90, 92, 94, 96, 98, 100, // C4 -> B4
+  102, 104, 106, 108, 110, 112, 114, 116, 118, 120, 122, 124, // C5 -> B5
+  126, 128, 130, 132, 134, 136, 138, 140, 142, 144, 146, 148, // C6 -> B6
+  150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, // C7 -> B7
+  174 // C8
+};
+
+// Nearest key (index of keyData[]) of each LED
+const uint8_t ledKeyMap[TABLE_NUM_LEDS] PROGMEM =
+{
+  0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8,
+  8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16,
+  16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24,
+  24, 25, 25, 26, 26, 27, 27, 28, 28, 29, 29, 30, 30, 31, 31, 32,
+  32, 33, 33, 34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 39, 39, 40,
+  40, 41, 41, 42, 42, 43, 43, 44, 44, 45, 45, 46, 46, 47, 47, 48,
+  48, 49, 49, 50, 50, 51, 51, 52, 52, 53, 53, 54, 54, 55, 55, 56,
+  56, 57, 57, 58, 58, 59, 59, 60, 60, 61, 61, 62, 62, 63, 63, 64,
+  64, 65, 65, 66, 66, 67, 67, 68, 68, 69, 69, 70, 70, 71, 71, 72,
+  72, 73, 73, 74, 74, 75, 75, 76, 76, 77, 77, 78, 78, 79, 79, 80,
+  80, 81, 81, 82, 82, 83, 83, 84, 84, 85, 85, 86, 86, 87, 87
+};
+
+// MIDI code of each key (index of keyData[])
+const uint8_t keyMidiMap[TABLE_NUM_KEYS] PROGMEM =
+{
+  21, 22, 23, // A0 -> B0
+  24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, // C1 -> B1
+  36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, // C2 -> B2
+  48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, // C3 -> B3
+  60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, // C4 -> B4
+  72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, // C5 -> B5
+  84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, // C6 -> B6
+  96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, // C7 -> B7
+  108 // C8
+};
+
+// Key (index of keyData[]) of each MIDI code, 0xFF: not on keyboard
+const uint8_t midiKeyMap[128] PROGMEM =
+{
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+  11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,
+  27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42,
+  43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58,
+  59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74,
+  75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+};
+
+// Key alpha by note on velocity
+const uint8_t velocityAlphaMap[128] PROGMEM =
+{
+  1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31,
+  33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63,
+  65, 67, 69, 71, 73, 75, 77, 79, 81, 83, 85, 87, 89, 91, 93, 95,
+  97, 99, 101, 103, 105, 107, 109, 111, 113, 115, 117, 119, 121, 123, 125, 127,
+  129, 131, 133, 135, 137, 139, 141, 143, 145, 147, 149, 151, 153, 155, 157, 159,
+  161, 163, 165, 167, 169, 171, 173, 175, 177, 179, 181, 183, 185, 187, 189, 191,
+  193, 195, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221, 223,
+  225, 227, 229, 231, 233, 235, 237, 239, 241, 243, 245, 247, 249, 251, 253, 255
+};
+
+// Gamma 2.2: 8-bit perceived brightness -> 16-bit linear LED output
+const uint16_t gammaTable[256] PROGMEM =
+{
+  0, 0, 2, 4, 7, 11, 17, 24, 32, 42, 53, 65, 79, 94, 111, 129,
+  148, 169, 192, 216, 242, 270, 299, 330, 362, 396, 432, 469, 508, 549, 591, 635,
+  681, 729, 779, 830, 883, 938, 995, 1053, 1113, 1175, 1239, 1305, 1373, 1443, 1514, 1587,
+  1663, 1740, 1819, 1900, 1983, 2068, 2155, 2243, 2334, 2427, 2521, 2618, 2717, 2817, 2920, 3024,
+  3131, 3240, 3350, 3463, 3578, 3694, 3813, 3934, 4057, 4182, 4309, 4438, 4570, 4703, 4838, 4976,
+  5115, 5257, 5401, 5547, 5695, 5845, 5998, 6152, 6309, 6468, 6629, 6792, 6957, 7124, 7294, 7466,
+  7640, 7816, 7994, 8175, 8358, 8543, 8730, 8919, 9111, 9305, 9501, 9699, 9900, 10102, 10307, 10515,
+  10724, 10936, 11150, 11366, 11585, 11806, 12029, 12254, 12482, 12712, 12944, 13179, 13416, 13655, 13896, 14140,
+  14386, 14635, 14885, 15138, 15394, 15652, 15912, 16174, 16439, 16706, 16975, 17247, 17521, 17798, 18077, 18358,
+  18642, 18928, 19216, 19507, 19800, 20095, 20393, 20694, 20996, 21301, 21609, 21919, 22231, 22546, 22863, 23182,
+  23504, 23829, 24156, 24485, 24817, 25151, 25487, 25826, 26168, 26512, 26858, 27207, 27558, 27912, 28268, 28627,
+  28988, 29351, 29717, 30086, 30457, 30830, 31206, 31585, 31966, 32349, 32735, 33124, 33514, 33908, 34304, 34702,
+  35103, 35507, 35913, 36321, 36732, 37146, 37562, 37981, 38402, 38825, 39252, 39680, 40112, 40546, 40982, 41421,
+  41862, 42306, 42753, 43202, 43654, 44108, 44565, 45025, 45487, 45951, 46418, 46888, 47360, 47835, 48313, 48793,
+  49275, 49761, 50249, 50739, 51232, 51728, 52226, 52727, 53230, 53736, 54245, 54756, 55270, 55787, 56306, 56828,
+  57352, 57879, 58409, 58941, 59476, 60014, 60554, 61097, 61642, 62190, 62741, 63295, 63851, 64410, 64971, 65535
+};
+
+// Hue of pure colors (color code 0x00 - 0x0A)
+#define PALETTE_HUE_NUM 11
+const uint8_t paletteHueList[PALETTE_HUE_NUM] PROGMEM =
+{
+  0, // off
+  0, // white
+  0, // red
+  20, // orange
+  45, // yellow
+  70, // yellowGreen
+  92, // green
+  120, // cyan
+  154, // blue
+  176, // purple
+  224 // magenta
+};
+
+// Start & stop hue of gradient colors (subcode 0x00 - 0x07, 0x00: rainbow)
+#define GRADIENT_HUE_NUM 8
+const uint8_t gradientHueList[GRADIENT_HUE_NUM][2] PROGMEM =
+{
+  {0, 0}, // red -> red
+  {0, 45}, // red -> yellow
+  {45, 92}, // yellow -> green
+  {92, 154}, // green -> blue
+  {154, 224}, // blue -> magenta
+  {0, 92}, // red -> green
+  {45, 154}, // yellow -> blue
+  {92, 224} // green -> magenta
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef LAYER_CONTROL_H
+#define LAYER_CONTROL_H
+
+#include "ColorControl.h"
+#include "CoalesceControl.h"
+
+/*
+   Multi-channel key layers (MULTI_CHANNEL in LEDPianoConfig.h)
+   Notes on the channel of a layer in layerConfig[] are drawn by that layer with its own key animation & colors,
+   notes on other channels are drawn by the main style (keyData[]) and can control settings.
+   Each layer only keeps a list of its active keys (LAYER_MAX_KEYS), so the cost scales with playing notes.
+*/
+#ifdef MULTI_CHANNEL
+
+struct LayerKey {
+  uint8_t keyIndex; // index of keyData[]
+  KeyData data;
+};
+
+struct KeyLayer {
+  uint8_t channel;
+  uint8_t keyAnimation;
+  uint8_t whiteKeyColor;
+  uint8_t whiteKeySV;
+  uint8_t blackKeyColor;
+  uint8_t blackKeySV;
+  float increaseFactor;
+  float fadeFactorPress;
+  float fadeFactorRelease;
+  uint8_t activeNum;
+  LayerKey activeKeys[LAYER_MAX_KEYS];
+};
+
+KeyLayer keyLayers[LAYER_NUM];
+
+void initLayers() {
+  for (uint8_t l = 0; l < LAYER_NUM; ++l) {
+    KeyLayer& layer = keyLayers[l];
+    layer.channel = readProgmem(&layerConfig[l][0]);
+    layer.keyAnimation = readProgmem(&layerConfig[l][1]);
+    layer.whiteKeyColor = readProgmem(&layerConfig[l][2]);
+    layer.whiteKeySV = readProgmem(&layerConfig[l][3]);
+    layer.blackKeyColor = readProgmem(&layerConfig[l][4]);
+    layer.blackKeySV = readProgmem(&layerConfig[l][5]);
+    layer.increaseFactor = 0.0;
+    layer.fadeFactorPress = 0.97;
+    layer.fadeFactorRelease = 0.3;
+    getKeyAnimationFactors(layer.keyAnimation, layer.increaseFactor, layer.fadeFactorPress, layer.fadeFactorRelease);
+    layer.activeNum = 0;
+  }
+}
+
+uint8_t getLayerIndex(uint8_t channel) {
+  for (uint8_t l = 0; l < LAYER_NUM; ++l) {
+    if (keyLayers[l].channel == channel) {
+      return l;
+    }
+  }
+  return 0xFF; // main style
+}
+
+int8_t findLayerKey(KeyLayer& layer, uint8_t keyIndex) {
+  for (uint8_t k = 0; k < layer.activeNum; ++k) {
+    if (layer.activeKeys[k].keyIndex == keyIndex) {
+      return k;
+    }
+  }
+  return -1;
+}
+
+void activateLayerKey(uint8_t layerIndex, uint8_t keyIndex, uint8_t velocity) {
+  KeyLayer& layer = keyLayers[layerIndex];
+  int8_t k = findLayerKey(layer, keyIndex);
+  if (k < 0) {
+    if (layer.activeNum < LAYER_MAX_KEYS) {
+      k = layer.activeNum++;
+    } else { // list is full, replace the dimmest key
+      k = 0;
+      for (uint8_t i = 1; i < LAYER_MAX_KEYS; ++i) {
+        if (layer.activeKeys[i].data.alpha < layer.activeKeys[k].data.alpha) {
+          k = i;
+        }
+      }
+    }
+    layer.activeKeys[k].keyIndex = keyIndex;
+    layer.activeKeys[k].data.alpha = 0;
+    layer.activeKeys[k].data.control = keyData[keyIndex].control & 0x80; // black key
+  }
+  activateKeyData(layer.activeKeys[k].data, velocity, layer.whiteKeyColor, layer.blackKeyColor, layer.increaseFactor);
+}
+
+void deactivateLayerKey(uint8_t layerIndex, uint8_t keyIndex) {
+  KeyLayer& layer = keyLayers[layerIndex];
+  int8_t k = findLayerKey(layer, keyIndex);
+  if (k >= 0) {
+    deactivateKey(layer.activeKeys[k].data);
+  }
+}
+
+void blendLayerColors() {
+  for (uint8_t l = 0; l < LAYER_NUM; ++l) {
+    KeyLayer& layer = keyLayers[l];
+    if (layer.keyAnimation == 0x00) {
+      continue; // turn off key animation
+    }
+    for (uint8_t k = 0; k < layer.activeNum; ++k) {
+      LayerKey& key = layer.activeKeys[k];
+      if (key.data.alpha > 0) {
+        CRGB currentFgColor = getKeyColorBy(key.data, key.keyIndex, getKeyMidi(key.keyIndex),
+                                            layer.whiteKeyColor, layer.whiteKeySV, layer.blackKeyColor, layer.blackKeySV);
+        blendKeyColor(key.keyIndex, currentFgColor, key.data.alpha);
+      }
+    }
+  }
+}
+
+void updateLayerAlpha() {
+  for (uint8_t l = 0; l < LAYER_NUM; ++l) {
+    KeyLayer& layer = keyLayers[l];
+    for (uint8_t k = 0; k < layer.activeNum;) {
+      LayerKey& key = layer.activeKeys[k];
+      if (key.data.control & 0x40) { // refreshing
+        updateAlpha(key.data, layer.increaseFactor, layer.fadeFactorPress, layer.fadeFactorRelease);
+      }
+      if (key.data.control & 0x40) {
+        ++k;
+      } else { // faded out, remove from list
+        key = layer.activeKeys[--layer.activeNum];
+      }
+    }
+  }
+}
+
+#endif
+
+void releaseAllKeys() {
+  // Note off of held keys will never come (instrument unplugged, replay restarted ...)
+#ifdef MIDI_COALESCE
+  clearCoalescedNotes(); // don't press keys again on the next frame
+#endif
+  for (uint8_t i = 0; i < NUM_KEYS; ++i) {
+    if (keyData[i].control & 0x20) {
+      deactivateKey(keyData[i]);
+    }
+  }
+#ifdef MULTI_CHANNEL
+  for (uint8_t l = 0; l < LAYER_NUM; ++l) {
+    for (uint8_t k = 0; k < keyLayers[l].activeNum; ++k) {
+      deactivateKey(keyLayers[l].activeKeys[k].data);
+    }
+  }
+#endif
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef LOOKAHEAD_CONTROL_H
+#define LOOKAHEAD_CONTROL_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   Look-ahead note scheduling for playback from computer (LOOKAHEAD in LEDPianoConfig.h)
+   Host side: /Misc/LEDPianoLookahead.py, sends notes ahead of time via SysEx (see SysExControl.h):
+     command 0x20: schedule notes, data = N * (t0 t1 t2 status channel note velocity)
+                   t0 - t2: host time in ms (21 bits, 7 bits each, LSB first)
+                   status: 0x08 note off, 0x09 note on (high nibble of MIDI status)
+     command 0x21: clock sync, data = t0 t1 t2 (current host time)
+   Notes are kept in a time-ordered queue and processed on the frame they are shown.
+   While scheduled notes keep coming, note on/off from computer (MIDIUSB) only go to the piano, not the LEDs.
+*/
+#ifdef LOOKAHEAD
+
+#define LOOKAHEAD_TIME_MASK 0x1FFFFFUL // 21-bit host time
+#define LOOKAHEAD_NOTE_SIZE 7 // bytes of each note in schedule command
+
+struct ScheduledNote {
+  uint32_t dueTime; // millis()
+  uint8_t status;
+  uint8_t note;
+  uint8_t velocity;
+};
+
+ScheduledNote scheduledNotes[LOOKAHEAD_QUEUE_SIZE];
+uint8_t scheduledNoteNum = 0;
+uint32_t lookaheadClockOffset = 0; // millis() - host time
+uint32_t lastScheduleTime = 0; // millis() of the last scheduled note
+bool lookaheadSynced = false;
+uint8_t lookaheadBuffer[LOOKAHEAD_NOTE_SIZE];
+
+uint32_t getLookaheadTime(const uint8_t data[]) {
+  return uint32_t(data[0]) | (uint32_t(data[1]) << 7) | (uint32_t(data[2]) << 14);
+}
+
+uint32_t getLocalTime(uint32_t hostTime) {
+  // Host time is 21 bits, convert with the signed difference from current host time
+  uint32_t hostNow = (millis() - lookaheadClockOffset) & LOOKAHEAD_TIME_MASK;
+  uint32_t diff = (hostTime - hostNow) & LOOKAHEAD_TIME_MASK;
+  if (diff & 0x100000UL) { // negative (already late)
+    return millis() - ((LOOKAHEAD_TIME_MASK + 1) - diff);
+  }
+  return millis() + diff;
+}
+
+void syncLookaheadClock(const uint8_t data[]) {
+  lookaheadClockOffset = millis() - getLookaheadTime(data);
+  lookaheadSynced = true;
+}
+
+bool isLookaheadActive() {
+  return lookaheadSynced && (scheduledNoteNum > 0 || millis() - lastScheduleTime < LOOKAHEAD_HOLD_TIME);
+}
+
+void scheduleNote(const uint8_t data[]) {
+  if (!lookaheadSynced) {
+    return;
+  }
+  if (scheduledNoteNum >= LOOKAHEAD_QUEUE_SIZE) {
+#ifdef DEBUG
+    Serial.println(F("Look-ahead queue full"));
+#endif
+    return;
+  }
+  ScheduledNote note = {getLocalTime(getLookaheadTime(data)), uint8_t((data[3] << 4) | (data[4] & 0x0F)), data[5], data[6]};
+  uint8_t i = scheduledNoteNum++;
+  while (i > 0 && int32_t(scheduledNotes[i - 1].dueTime - note.dueTime) > 0) { // usually in order, no shift
+    scheduledNotes[i] = scheduledNotes[i - 1];
+    --i;
+  }
+  scheduledNotes[i] = note;
+  lastScheduleTime = millis();
+}
+
+void receiveLookaheadByte(uint8_t command, uint16_t dataIndex, uint8_t data) {
+  // dataIndex: index after SysEx command byte
+  uint8_t bufferIndex = dataIndex % LOOKAHEAD_NOTE_SIZE;
+  lookaheadBuffer[bufferIndex] = data;
+  if (command == 0x21 && dataIndex == 2) {
+    syncLookaheadClock(lookaheadBuffer);
+  } else if (command == 0x20 && bufferIndex == LOOKAHEAD_NOTE_SIZE - 1) {
+    scheduleNote(lookaheadBuffer);
+  }
+}
+
+bool popScheduledNote(uint8_t outBuf[], uint32_t showTime) {
+  // Get the earliest note shown at showTime as a USB-MIDI packet, false if none
+  if (scheduledNoteNum == 0 || int32_t(scheduledNotes[0].dueTime - showTime) > 0) {
+    return false;
+  }
+  outBuf[0] = scheduledNotes[0].status >> 4;
+  outBuf[1] = scheduledNotes[0].status;
+  outBuf[2] = scheduledNotes[0].note;
+  outBuf[3] = scheduledNotes[0].velocity;
+  --scheduledNoteNum;
+  for (uint8_t i = 0; i < scheduledNoteNum; ++i) {
+    scheduledNotes[i] = scheduledNotes[i + 1];
+  }
+  return true;
+}
+
+#endif
+
+#endif
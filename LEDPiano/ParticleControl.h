@@ -0,0 +1,109 @@
+#ifndef PARTICLE_CONTROL_H
+#define PARTICLE_CONTROL_H
+
+#include "ColorControl.h"
+
+/*
+   Particle effects for key animation 10 (ripple) and 11 (sparks)
+   Particles live in a fixed pool (no heap), new particles are always placed at particleNext,
+   which walks the pool in spawn order, so a full pool evicts the oldest particle.
+   Position and speed are in LEDs with 8 fractional bits (position unsigned: 175 LEDs << 8 needs 16 bits).
+*/
+#ifdef PARTICLE_EFFECT
+
+static_assert(NUM_LEDS <= 256, "Particle positions are limited to 256 LEDs");
+
+struct Particle {
+  uint16_t position;
+  int16_t speed;
+  uint8_t life; // remaining brightness, 0: free
+  uint8_t fade; // brightness lost per frame
+  uint8_t friction; // speed -= speed >> friction per frame, 0: no friction
+  CRGB color;
+};
+Particle particles[PARTICLE_POOL_SIZE];
+uint8_t particleNext = 0;
+
+void spawnParticle(uint16_t position, int16_t speed, uint8_t fade, uint8_t friction, const CRGB& color) {
+  Particle& newParticle = particles[particleNext];
+  if (++particleNext >= PARTICLE_POOL_SIZE) {
+    particleNext = 0;
+  }
+  newParticle.position = position;
+  newParticle.speed = speed;
+  newParticle.life = 0xFF;
+  newParticle.fade = fade;
+  newParticle.friction = friction;
+  newParticle.color = color;
+}
+
+void spawnKeyParticles(uint8_t keyIndex, uint8_t velocity, const CRGB& color) {
+  uint16_t position = uint16_t(getKeyLed(keyIndex)) << 8;
+  switch (keyAnimation) {
+    case 10: { // ripple: two waves running to both sides, faster when pressed harder
+        int16_t speed = 0x40 + (int16_t(velocity) << 2); // 0.25 - 2.2 LEDs per frame
+        spawnParticle(position, speed, 6, 0, color);
+        spawnParticle(position, -speed, 6, 0, color);
+        break;
+      }
+
+    case 11: { // sparks: 1 - 3 sparks shooting out, slowing down by friction
+        uint8_t sparkNum = 1 + velocity / 43;
+        for (uint8_t k = 0; k < sparkNum; ++k) {
+          int16_t speed = (int16_t(velocity) << 1) + int16_t(random(0, 0x100));
+          spawnParticle(position, random(0, 2) ? speed : -speed, 10, 3, color);
+        }
+        break;
+      }
+
+    default: break;
+  }
+}
+
+void renderParticles() {
+  // Add particles to leds, split between two neighbour LEDs by fractional position
+  for (uint8_t p = 0; p < PARTICLE_POOL_SIZE; ++p) {
+    if (particles[p].life == 0) {
+      continue;
+    }
+    uint8_t ledNum = particles[p].position >> 8;
+    uint8_t ledFrac = particles[p].position & 0xFF;
+    CRGB leftColor = particles[p].color;
+    CRGB rightColor = particles[p].color;
+    leftColor.nscale8((uint16_t(particles[p].life) * (0x100 - ledFrac)) >> 8);
+    rightColor.nscale8((uint16_t(particles[p].life) * ledFrac) >> 8);
+    leds[ledNum] += leftColor;
+#ifdef SPARSE_BACKGROUND
+    markBgDirty(ledNum);
+#endif
+    if (ledNum + 1 < NUM_LEDS) {
+      leds[ledNum + 1] += rightColor;
+#ifdef SPARSE_BACKGROUND
+      markBgDirty(ledNum + 1);
+#endif
+    }
+  }
+}
+
+void updateParticles() {
+  const static int32_t maxPosition = int32_t(NUM_LEDS - 1) << 8;
+  for (uint8_t p = 0; p < PARTICLE_POOL_SIZE; ++p) {
+    if (particles[p].life == 0) {
+      continue;
+    }
+    int32_t position = int32_t(particles[p].position) + particles[p].speed; // 32-bit: may leave the strip on both ends
+    if (particles[p].friction) {
+      particles[p].speed -= particles[p].speed >> particles[p].friction;
+    }
+    if (position < 0 || position > maxPosition || particles[p].life <= particles[p].fade) {
+      particles[p].life = 0;
+    } else {
+      particles[p].position = position;
+      particles[p].life -= particles[p].fade;
+    }
+  }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef PLATFORM_ARDUINO_H
+#define PLATFORM_ARDUINO_H
+
+#include <usbh_midi.h>
+#include <usbhub.h>
+#include <EEPROM.h>
+
+/*
+   AVR boards (UNO, Leonardo ...) with USB Host Shield, see PlatformControl.h
+   Single core: USB host is polled in loop() between frames.
+*/
+
+USB Usb;
+USBH_MIDI Midi(&Usb);
+
+void initStrip() {
+  FastLED.addLeds<WS2812B, STRIP_PIN, GRB>(leds, NUM_LEDS); // Remider: here RGB order is "GRB" for WS2812B
+}
+
+void showStrip() {
+  FastLED.show();
+}
+
+bool initMidiHost() {
+  return Usb.Init() != -1;
+}
+
+void midiHostTask() {
+  Usb.Task();
+}
+
+bool isMidiConnected() {
+  return bool(Midi);
+}
+
+uint16_t receiveMidi(uint8_t outBuf[]) {
+  return Midi.RecvRawData(outBuf);
+}
+
+void sendMidi(uint8_t outBuf[]) {
+  Midi.SendRawData(4, outBuf);
+}
+
+uint8_t readStorage(int address) {
+  return EEPROM.read(address);
+}
+
+void writeStorage(int address, uint8_t data) {
+  EEPROM.update(address, data); // only write if changed
+}
+
+void commitStorage() {
+  // EEPROM is written immediately on AVR
+}
+
+#endif
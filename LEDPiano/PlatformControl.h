@@ -0,0 +1,74 @@
+#ifndef PLATFORM_CONTROL_H
+#define PLATFORM_CONTROL_H
+
+/*
+   Hardware abstraction layer, one backend is selected by the board:
+     PlatformArduino.h: AVR boards (UNO, Leonardo ...) with USB Host Shield, single core (default)
+     PlatformRp2040.h: RP2040 (arduino-pico core) with USB Host Shield, core 1 runs USB / MIDI input,
+                       core 0 renders frames, MIDI packets are passed by a lock-free queue (PLATFORM_DUAL_CORE)
+     PlatformHost.h: Linux / macOS build (/Host, LEDPIANO_HOST), an I/O thread reads MIDI packets (PLATFORM_DUAL_CORE)
+
+   Each backend implements:
+     void initStrip() / void showStrip(): LED strip output of leds[]
+     bool initMidiHost(): false if USB host is not working (yet), called again to retry (see ConnectionControl.h)
+     void midiHostTask(): poll USB host (no-op on dual core, done by the I/O core)
+     bool isMidiConnected()
+     uint16_t receiveMidi(uint8_t outBuf[]): 4-byte USB-MIDI packet, returns 0 if none
+     void sendMidi(uint8_t outBuf[]): send 4-byte USB-MIDI packet to the instrument
+     uint8_t readStorage(int address) / void writeStorage(int address, uint8_t data) / void commitStorage()
+   Timers: millis() & micros() of the Arduino core (or the host shim)
+*/
+
+#if defined(LEDPIANO_HOST) || defined(ARDUINO_ARCH_RP2040)
+#define PLATFORM_DUAL_CORE
+#endif
+
+#ifdef PLATFORM_DUAL_CORE
+#include <atomic>
+
+#define MIDI_QUEUE_SIZE 64 // power of 2
+
+struct MidiPacketQueue {
+  // Single producer (I/O core) / single consumer (render core) ring buffer
+  uint8_t packets[MIDI_QUEUE_SIZE][4];
+  std::atomic<uint8_t> head; // next packet to read, written by consumer
+  std::atomic<uint8_t> tail; // next packet to write, written by producer
+  std::atomic<uint16_t> dropCount; // packets lost because queue is full
+
+  bool isFull() const {
+    return ((tail.load(std::memory_order_relaxed) + 1) & (MIDI_QUEUE_SIZE - 1)) == head.load(std::memory_order_acquire);
+  }
+
+  bool push(const uint8_t packet[]) {
+    uint8_t currentTail = tail.load(std::memory_order_relaxed);
+    uint8_t nextTail = (currentTail + 1) & (MIDI_QUEUE_SIZE - 1);
+    if (nextTail == head.load(std::memory_order_acquire)) {
+      dropCount.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    memcpy(packets[currentTail], packet, 4);
+    tail.store(nextTail, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(uint8_t packet[]) {
+    uint8_t currentHead = head.load(std::memory_order_relaxed);
+    if (currentHead == tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    memcpy(packet, packets[currentHead], 4);
+    head.store((currentHead + 1) & (MIDI_QUEUE_SIZE - 1), std::memory_order_release);
+    return true;
+  }
+};
+#endif
+
+#if defined(LEDPIANO_HOST)
+#include "PlatformHost.h"
+#elif defined(ARDUINO_ARCH_RP2040)
+#include "PlatformRp2040.h"
+#else
+#include "PlatformArduino.h"
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef PLATFORM_HOST_H
+#define PLATFORM_HOST_H
+
+#include <thread>
+#include <chrono>
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+#include "HostEmulator.h"
+
+/*
+   Linux / macOS build of the sketch (/Host, LEDPIANO_HOST), see PlatformControl.h
+   MIDI input from $LEDPIANO_MIDI_IN (stdin if not set), read by an I/O thread and passed to loop() by midiInQueue:
+     *.mid / *.midi: Standard MIDI File, played in real time ($LEDPIANO_MIDI_LOOP=1: start over at the end)
+     other files / FIFO (virtual MIDI port stand-in): raw 4-byte USB-MIDI packets, played as they arrive
+   End of input = MIDI disconnected. The read time of each packet is kept for latency statistics.
+   Storage: $LEDPIANO_EEPROM file (kept in memory only if not set).
+   LED strip: every shown frame is passed to hostShowStrip() (/Host/HostMain.cpp).
+*/
+
+#define STORAGE_SIZE 1024
+
+MidiPacketQueue midiInQueue;
+uint32_t midiInTime[MIDI_QUEUE_SIZE]; // micros() when each packet in midiInQueue was read
+uint32_t receivedInputTime = HOST_NO_INPUT; // oldest packet received by loop() since the last shown frame
+#ifdef RENDER_AHEAD
+uint32_t renderedInputTime = HOST_NO_INPUT; // ... since the frame before, rendered after the last shown frame
+#endif
+std::atomic<bool> midiConnected(false);
+uint8_t hostStorage[STORAGE_SIZE];
+bool hostStorageLoaded = false;
+
+void pushMidiInput(const uint8_t packet[]) {
+  while (midiInQueue.isFull()) { // a file can be read faster than played, wait instead of dropping
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  midiInTime[midiInQueue.tail.load(std::memory_order_relaxed)] = micros(); // published by push()
+  midiInQueue.push(packet);
+}
+
+void playMidiFile(std::vector<HostMidiEvent> events, bool loop) {
+  midiConnected.store(true);
+  do {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const HostMidiEvent& event : events) {
+      std::this_thread::sleep_until(start + std::chrono::microseconds(event.time));
+      pushMidiInput(event.packet);
+    }
+  } while (loop && !events.empty());
+  midiConnected.store(false);
+}
+
+void readMidiInput(int fd) {
+  uint8_t packet[4];
+  size_t received = 0;
+  midiConnected.store(true);
+  while (true) {
+    ssize_t size = read(fd, packet + received, 4 - received);
+    if (size <= 0) {
+      break;
+    }
+    received += size;
+    if (received == 4) {
+      pushMidiInput(packet);
+      received = 0;
+    }
+  }
+  midiConnected.store(false);
+}
+
+void initStrip() {
+}
+
+void showStrip() {
+#ifdef RENDER_AHEAD
+  hostShowStrip(leds, NUM_LEDS, renderedInputTime); // packets are rendered after the frame is shown, seen one frame later
+  renderedInputTime = receivedInputTime;
+#else
+  hostShowStrip(leds, NUM_LEDS, receivedInputTime);
+#endif
+  receivedInputTime = HOST_NO_INPUT;
+}
+
+bool initMidiHost() {
+  const char* path = getenv("LEDPIANO_MIDI_IN");
+  const char* extension = path ? strrchr(path, '.') : NULL;
+  if (extension && (strcasecmp(extension, ".mid") == 0 || strcasecmp(extension, ".midi") == 0)) {
+    std::vector<HostMidiEvent> events;
+    if (!hostLoadMidiFile(path, events)) {
+      return false;
+    }
+    const char* loop = getenv("LEDPIANO_MIDI_LOOP");
+    std::thread(playMidiFile, events, loop && strcmp(loop, "0") != 0).detach();
+    return true;
+  }
+  int fd = path ? open(path, O_RDONLY) : STDIN_FILENO;
+  if (fd < 0) {
+    return false;
+  }
+  std::thread(readMidiInput, fd).detach();
+  return true;
+}
+
+void midiHostTask() {
+  // done by the I/O thread
+}
+
+bool isMidiConnected() {
+  return midiConnected.load();
+}
+
+uint16_t receiveMidi(uint8_t outBuf[]) {
+  uint8_t index = midiInQueue.head.load(std::memory_order_relaxed);
+  if (!midiInQueue.pop(outBuf)) {
+    return 0;
+  }
+  if (receivedInputTime == HOST_NO_INPUT) {
+    receivedInputTime = midiInTime[index];
+  }
+  return 4;
+}
+
+void sendMidi(uint8_t[]) {
+  // no instrument attached
+}
+
+uint8_t readStorage(int address) {
+  if (!hostStorageLoaded) {
+    memset(hostStorage, 0xFF, STORAGE_SIZE); // erased EEPROM
+    const char* path = getenv("LEDPIANO_EEPROM");
+    FILE* file = path ? fopen(path, "rb") : NULL;
+    if (file) {
+      fread(hostStorage, 1, STORAGE_SIZE, file);
+      fclose(file);
+    }
+    hostStorageLoaded = true;
+  }
+  return hostStorage[address];
+}
+
+void writeStorage(int address, uint8_t data) {
+  readStorage(address);
+  hostStorage[address] = data;
+}
+
+void commitStorage() {
+  const char* path = getenv("LEDPIANO_EEPROM");
+  FILE* file = path ? fopen(path, "wb") : NULL;
+  if (file) {
+    fwrite(hostStorage, 1, STORAGE_SIZE, file);
+    fclose(file);
+  }
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef PLATFORM_RP2040_H
+#define PLATFORM_RP2040_H
+
+#include <usbh_midi.h>
+#include <usbhub.h>
+#include <EEPROM.h>
+
+/*
+   RP2040 (arduino-pico core) with USB Host Shield, see PlatformControl.h
+   Core 1 (setup1() / loop1()) owns the USB host: polls it and pushes received MIDI packets to midiInQueue.
+   Core 0 (setup() / loop()) renders frames and processes MIDI packets from the queue,
+   so all LED & key states are only touched by core 0.
+*/
+
+#define STORAGE_SIZE 1024 // emulated EEPROM in flash
+
+USB Usb;
+USBH_MIDI Midi(&Usb);
+
+MidiPacketQueue midiInQueue; // core 1 -> core 0
+MidiPacketQueue midiOutQueue; // core 0 -> core 1
+std::atomic<uint8_t> usbHostStatus(0); // 0: init requested, 1: running, 2: error
+std::atomic<bool> midiConnected(false);
+
+void setup1() {
+}
+
+void loop1() {
+  if (usbHostStatus.load() == 0) { // first init, or retry requested by initMidiHost()
+    usbHostStatus.store(Usb.Init() == -1 ? 2 : 1);
+    return;
+  }
+  if (usbHostStatus.load() != 1) {
+    return;
+  }
+  Usb.Task();
+  bool connected = bool(Midi);
+  midiConnected.store(connected);
+  if (connected) {
+    uint8_t packet[4];
+    while (Midi.RecvRawData(packet) > 0) {
+      midiInQueue.push(packet);
+    }
+    while (midiOutQueue.pop(packet)) {
+      Midi.SendRawData(4, packet);
+    }
+  }
+}
+
+void initStrip() {
+  FastLED.addLeds<WS2812B, STRIP_PIN, GRB>(leds, NUM_LEDS);
+}
+
+void showStrip() {
+  FastLED.show();
+}
+
+bool initMidiHost() {
+  // Doesn't wait for core 1: false while Usb.Init() is pending, the retry timer of ConnectionControl.h polls again
+  uint8_t status = usbHostStatus.load();
+  if (status == 2) {
+    usbHostStatus.store(0); // retry on core 1
+  }
+  return status == 1;
+}
+
+void midiHostTask() {
+  // done by core 1
+}
+
+bool isMidiConnected() {
+  return midiConnected.load();
+}
+
+uint16_t receiveMidi(uint8_t outBuf[]) {
+  return midiInQueue.pop(outBuf) ? 4 : 0;
+}
+
+void sendMidi(uint8_t outBuf[]) {
+  midiOutQueue.push(outBuf);
+}
+
+uint8_t readStorage(int address) {
+  static bool storageReady = false;
+  if (!storageReady) {
+    EEPROM.begin(STORAGE_SIZE);
+    storageReady = true;
+  }
+  return EEPROM.read(address);
+}
+
+void writeStorage(int address, uint8_t data) {
+  if (readStorage(address) != data) {
+    EEPROM.write(address, data);
+  }
+}
+
+void commitStorage() {
+  EEPROM.commit(); // write flash only if changed
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef PROFILE_CONTROL_H
+#define PROFILE_CONTROL_H
+
+#include "FrameControl.h"
+
+/*
+   Hot path profiling via serial (PROFILE in LEDPianoConfig.h)
+   Serial commands (one character, any line ending, see checkSerialCommand()):
+     p: print report    r: reset counters    h: help
+   Stage time is measured by micros() (4us resolution on 16MHz AVR).
+   When a stage total would overflow, its total & count are halved together: the average stays live
+   and weighs recent calls more, the count is then the number of calls of that window.
+*/
+#define PROFILE_BG 0 // blendBgColors()
+#define PROFILE_FG 1 // blendFgColors()
+#define PROFILE_KEY_ALPHA 2 // updateKeyAlpha()
+#define PROFILE_CONFIG 3 // showConfigAll()
+#define PROFILE_SHOW 4 // FastLED.show()
+#define PROFILE_USB 5 // Usb.Task()
+#define PROFILE_STAGE_NUM 6
+
+#ifdef PROFILE
+
+#define PROFILE_STAGE(stage, code) { uint32_t profileStart = micros(); code; recordProfile(stage, profileStart); }
+
+struct ProfileStage {
+  uint32_t totalTime;
+  uint32_t count;
+  uint16_t maxTime;
+};
+ProfileStage profileStages[PROFILE_STAGE_NUM];
+uint32_t profileStartTime = 0;
+uint32_t midiEventCount = 0;
+uint32_t coalescedEventCount = 0; // MIDI_COALESCE: events merged into a key with pending events
+
+void recordProfile(uint8_t stage, uint32_t startTime) {
+  uint32_t stageTime = micros() - startTime;
+  ProfileStage& currentStage = profileStages[stage];
+  if (currentStage.totalTime > 0xFFFFFFFF - stageTime || currentStage.count == 0xFFFFFFFF) {
+    currentStage.totalTime >>= 1;
+    currentStage.count >>= 1;
+  }
+  currentStage.totalTime += stageTime;
+  if (stageTime > currentStage.maxTime) {
+    currentStage.maxTime = stageTime > 0xFFFF ? 0xFFFF : stageTime;
+  }
+  ++currentStage.count;
+}
+
+void resetProfile() {
+  for (uint8_t s = 0; s < PROFILE_STAGE_NUM; ++s) {
+    profileStages[s].totalTime = 0;
+    profileStages[s].maxTime = 0;
+    profileStages[s].count = 0;
+  }
+  midiEventCount = 0;
+  coalescedEventCount = 0;
+  frameOverrunCount = 0;
+  profileStartTime = millis();
+}
+
+int getFreeMemory() {
+#ifdef __AVR__
+  extern char __heap_start;
+  extern char* __brkval;
+  char stackTop;
+  return __brkval ? &stackTop - __brkval : &stackTop - &__heap_start;
+#else
+  return -1;
+#endif
+}
+
+#ifdef __AVR__
+#define STACK_PAINT 0xC5
+
+extern uint8_t _end; // end of .data & .bss
+extern uint8_t __stack; // top of SRAM
+
+void paintStack() __attribute__((naked, used, section(".init3")));
+void paintStack() {
+  // Fill free SRAM with STACK_PAINT before main(), bytes never touched by stack (or heap) keep the paint
+  uint8_t* p = &_end;
+  while (p <= &__stack) {
+    *p++ = STACK_PAINT;
+  }
+}
+#endif
+
+int getUnusedStack() {
+  // Stack high-water mark: free SRAM that has never been used since boot
+#ifdef __AVR__
+  extern char* __brkval;
+  const uint8_t* p = __brkval ? (const uint8_t*)__brkval : &_end;
+  int unused = 0;
+  while (p <= &__stack && *p == STACK_PAINT) {
+    ++p;
+    ++unused;
+  }
+  return unused;
+#else
+  return -1;
+#endif
+}
+
+void printStageName(uint8_t stage) {
+  switch (stage) { // F(): keep strings in flash
+    case PROFILE_BG: Serial.print(F("blendBgColors")); break;
+    case PROFILE_FG: Serial.print(F("blendFgColors")); break;
+    case PROFILE_KEY_ALPHA: Serial.print(F("updateKeyAlpha")); break;
+    case PROFILE_CONFIG: Serial.print(F("showConfigAll")); break;
+    case PROFILE_SHOW: Serial.print(F("FastLED.show")); break;
+    case PROFILE_USB: Serial.print(F("Usb.Task")); break;
+    default: break;
+  }
+}
+
+void printProfile() {
+  uint32_t elapsed = millis() - profileStartTime;
+  Serial.println(F("stage: avg[us] max[us] count"));
+  for (uint8_t s = 0; s < PROFILE_STAGE_NUM; ++s) {
+    printStageName(s);
+    Serial.print(F(": "));
+    Serial.print(profileStages[s].count ? profileStages[s].totalTime / profileStages[s].count : 0);
+    Serial.print(F(" "));
+    Serial.print(profileStages[s].maxTime);
+    Serial.print(F(" "));
+    Serial.println(profileStages[s].count);
+  }
+  Serial.print(F("MIDI events/s: "));
+  Serial.println(elapsed ? midiEventCount * 1000 / elapsed : 0);
+#ifdef MIDI_COALESCE
+  Serial.print(F("Coalesced MIDI events: "));
+  Serial.println(coalescedEventCount);
+#endif
+  Serial.print(F("Frame overruns: "));
+  Serial.println(frameOverrunCount);
+  Serial.print(F("Free SRAM: "));
+  Serial.println(getFreeMemory());
+  Serial.print(F("Never used SRAM: "));
+  Serial.println(getUnusedStack());
+}
+
+#else
+
+#define PROFILE_STAGE(stage, code) code;
+
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef PROGMEM_DATA_H
+#define PROGMEM_DATA_H
+
+#include <avr/pgmspace.h>
+
+/*
+   Accessors for read-only data in flash (PROGMEM)
+   On AVR, "const" data is still copied to SRAM at boot unless declared PROGMEM,
+   and PROGMEM data can only be read by pgm_read_*() / memcpy_P(), never by plain pointers.
+*/
+template <typename T>
+inline T readProgmem(const T* address) {
+  T data;
+  memcpy_P(&data, address, sizeof(T));
+  return data;
+}
+
+template <>
+inline uint8_t readProgmem<uint8_t>(const uint8_t* address) {
+  return pgm_read_byte(address);
+}
+
+template <>
+inline char readProgmem<char>(const char* address) {
+  return pgm_read_byte(address);
+}
+
+template <>
+inline uint16_t readProgmem<uint16_t>(const uint16_t* address) {
+  return pgm_read_word(address);
+}
+
+#endif
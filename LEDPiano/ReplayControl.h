@@ -0,0 +1,192 @@
+#ifndef REPLAY_CONTROL_H
+#define REPLAY_CONTROL_H
+
+#include "ConfigStorage.h"
+#include "LayerControl.h"
+
+/*
+   Replay mode (REPLAY_MODE in LEDPianoConfig.h)
+   Note on / off events from processMidi() are recorded into a ring buffer (the oldest events are overwritten),
+   playback loops the recording through processMidi() again, like notes from the instrument.
+   Each event is 3 bytes:
+     delta: time since the previous event in REPLAY_TICK ms (0 - 255)
+     note: MIDI note | 0x80 for note on
+     velocity: MIDI velocity, or a marker (bit 7 set):
+       0x80: wait only (delta longer than 255 ticks)
+       0x81: channel of the following events = note
+   Due times are accumulated from the deltas (no drift), events late by a slow frame are caught up in order.
+   When the ring buffer is full, the channel of the oldest events may be lost with an overwritten marker.
+   The recording can be saved to EEPROM after the config slots and is loaded at boot,
+   REPLAY_AUTOPLAY plays it at boot, so the LEDs run without instrument or USB host (demo / soak test).
+   Playback leaves setting mode, so replayed notes on setting keys don't change styles or write EEPROM.
+*/
+#ifdef REPLAY_MODE
+
+#define REPLAY_EVENT_SIZE 3
+#define REPLAY_WAIT 0x80
+#define REPLAY_CHANNEL 0x81
+#define REPLAY_STORAGE_ADDRESS CONFIG_STORAGE_END // after config slots, see ConfigStorage.h
+#define REPLAY_STORAGE_MARK 0xA5
+
+#ifdef E2END
+static_assert(REPLAY_STORAGE_ADDRESS + 2 + REPLAY_EVENT_NUM * REPLAY_EVENT_SIZE <= E2END + 1, "REPLAY_EVENT_NUM is too large for EEPROM");
+#endif
+
+#define REPLAY_IDLE 0
+#define REPLAY_RECORDING 1
+#define REPLAY_PLAYING 2
+
+uint8_t replayEvents[REPLAY_EVENT_NUM][REPLAY_EVENT_SIZE];
+uint8_t replayStart = 0; // oldest event
+uint8_t replayCount = 0;
+uint8_t replayPosition = 0; // next event to play (0 - replayCount)
+uint8_t replayState = REPLAY_IDLE;
+uint8_t replayChannel = 0; // recording: channel of the last event, playback: current channel
+uint32_t replayTime = 0; // recording: millis() of the last event (in whole ticks), playback: due time of the last event
+
+bool isReplayPlaying() {
+  return replayState == REPLAY_PLAYING;
+}
+
+void pushReplayEvent(uint8_t delta, uint8_t note, uint8_t velocity) {
+  uint8_t index = (replayStart + replayCount) % REPLAY_EVENT_NUM;
+  if (replayCount < REPLAY_EVENT_NUM) {
+    ++replayCount;
+  } else {
+    replayStart = (replayStart + 1) % REPLAY_EVENT_NUM; // overwrite the oldest event
+  }
+  replayEvents[index][0] = delta;
+  replayEvents[index][1] = note;
+  replayEvents[index][2] = velocity;
+}
+
+void startRecording() {
+  replayStart = 0;
+  replayCount = 0;
+  replayChannel = 0;
+  replayTime = millis();
+  replayState = REPLAY_RECORDING;
+}
+
+void recordReplayNote(const uint8_t outBuf[]) {
+  // Call for note on / off packets
+  if (replayState != REPLAY_RECORDING) {
+    return;
+  }
+  if (replayCount == 0) {
+    replayTime = millis(); // recording starts from the first note
+  }
+  uint32_t ticks = (millis() - replayTime) / REPLAY_TICK;
+  replayTime += ticks * REPLAY_TICK; // keep the remainder for the next event
+  while (ticks > 0xFF) {
+    pushReplayEvent(0xFF, 0x00, REPLAY_WAIT);
+    ticks -= 0xFF;
+  }
+  uint8_t channel = outBuf[1] & 0x0F;
+  if (channel != replayChannel) {
+    pushReplayEvent(ticks, channel, REPLAY_CHANNEL);
+    replayChannel = channel;
+    ticks = 0;
+  }
+  bool noteOn = (outBuf[1] & 0xF0) == 0x90 && outBuf[3] > 0;
+  pushReplayEvent(ticks, (outBuf[2] & 0x7F) | (noteOn ? 0x80 : 0x00), noteOn ? (outBuf[3] & 0x7F) : 0);
+}
+
+void startPlayback() {
+  if (replayCount == 0) {
+    return;
+  }
+  settingStatus = 0x00; // don't let replayed notes change settings
+  replayPosition = 0;
+  replayChannel = 0;
+  replayTime = millis();
+  replayState = REPLAY_PLAYING;
+}
+
+void stopReplay() {
+  if (replayState == REPLAY_PLAYING) {
+    releaseAllKeys();
+  }
+  replayState = REPLAY_IDLE;
+}
+
+bool popReplayNote(uint8_t outBuf[]) {
+  // Next due note of playback as USB-MIDI packet, false if none is due
+  while (replayState == REPLAY_PLAYING) {
+    if (replayPosition >= replayCount) { // loop
+      if (millis() - replayTime < REPLAY_LOOP_GAP) {
+        return false;
+      }
+      releaseAllKeys();
+      replayPosition = 0;
+      replayChannel = 0;
+      replayTime += REPLAY_LOOP_GAP;
+    }
+    const uint8_t* event = replayEvents[(replayStart + replayPosition) % REPLAY_EVENT_NUM];
+    uint16_t delta = replayPosition == 0 ? 0 : uint16_t(event[0]) * REPLAY_TICK; // oldest delta may be from an overwritten event
+    if (millis() - replayTime < delta) {
+      return false;
+    }
+    replayTime += delta;
+    ++replayPosition;
+    if (event[2] == REPLAY_CHANNEL) {
+      replayChannel = event[1] & 0x0F;
+    } else if (event[2] != REPLAY_WAIT) {
+      bool noteOn = (event[1] & 0x80) != 0;
+      outBuf[0] = noteOn ? 0x09 : 0x08;
+      outBuf[1] = (noteOn ? 0x90 : 0x80) | replayChannel;
+      outBuf[2] = event[1] & 0x7F;
+      outBuf[3] = event[2];
+      return true;
+    }
+  }
+  return false;
+}
+
+void saveReplay() {
+  // Ring buffer is saved from the oldest event
+  int address = REPLAY_STORAGE_ADDRESS;
+  writeStorage(address++, REPLAY_STORAGE_MARK);
+  writeStorage(address++, replayCount);
+  for (uint8_t i = 0; i < replayCount; ++i) {
+    const uint8_t* event = replayEvents[(replayStart + i) % REPLAY_EVENT_NUM];
+    for (uint8_t b = 0; b < REPLAY_EVENT_SIZE; ++b) {
+      writeStorage(address++, event[b]);
+    }
+  }
+  commitStorage();
+}
+
+bool loadReplay() {
+  int address = REPLAY_STORAGE_ADDRESS;
+  if (readStorage(address++) != REPLAY_STORAGE_MARK) {
+    return false;
+  }
+  uint8_t count = readStorage(address++);
+  if (count > REPLAY_EVENT_NUM) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; ++i) {
+    for (uint8_t b = 0; b < REPLAY_EVENT_SIZE; ++b) {
+      replayEvents[i][b] = readStorage(address++);
+    }
+  }
+  replayStart = 0;
+  replayCount = count;
+  return count > 0;
+}
+
+void printReplayState() {
+  Serial.print(F("Replay: "));
+  switch (replayState) {
+    case REPLAY_RECORDING: Serial.print(F("recording")); break;
+    case REPLAY_PLAYING: Serial.print(F("playing")); break;
+    default: Serial.print(F("idle")); break;
+  }
+  Serial.print(F(", events: "));
+  Serial.println(replayCount);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef SETTING_TABLE_H
+#define SETTING_TABLE_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   Setting table for nextStyle(), prevStyle(), nextSetting(), prevSetting() and showSetting()
+   Settings are visited in table order (nextSetting / prevSetting), skipping settings by skip flags.
+   Notice: add your new setting here with a new settingStatus code
+*/
+
+// SettingItem.type
+#define SETTING_LIST 0x00 // value in list, param = list length
+#define SETTING_SATURATION 0x01 // 0x?0 - 0xF0 of SV code
+#define SETTING_BRIGHTNESS 0x02 // 0x00 - 0x0? of SV code, param = max brightness
+
+// SettingItem.flags
+#define SKIP_BG_OFF 0x01 // skip if bgAnimation is turned off
+#define SKIP_NO_ACTIVATED 0x02 // skip if bgAnimation has no activated effect
+#define SKIP_KEY_OFF 0x04 // skip if keyAnimation is turned off
+#define SKIP_COLOR_OFF 0x08 // skip if color is turned off
+#define SKIP_COLOR_WHITE 0x10 // skip if color is white
+#define ON_CHANGE_RESET_FRAME 0x20 // reset frameCount after value changed
+#define ON_CHANGE_SETUP_KEY 0x40 // call setupKeyAnimation() after value changed
+#define ON_CHANGE_TRANSITION 0x80 // call startStyleTransition() before value changed
+
+// SettingItem.display: LEDs to show setting (0x?0) | dynamic channel (0x0?)
+#define DISPLAY_LEFT_BLINK 0x10 // settingLedLeft, blink
+#define DISPLAY_LEFT_SWEEP 0x20 // settingLedLeft, sweep
+#define DISPLAY_ALL_KEYS 0x30 // setting keys, blink
+#define DISPLAY_WHITE_KEYS 0x40 // white setting keys, blink
+#define DISPLAY_BLACK_KEYS 0x50 // black setting keys, blink
+#define DYNAMIC_NONE 0x00
+#define DYNAMIC_H 0x01
+#define DYNAMIC_S 0x02
+#define DYNAMIC_V 0x03
+
+struct SettingItem {
+  uint8_t status; // settingStatus
+  uint8_t* value; // variable to adjust
+  const uint8_t* list; // list of values in PROGMEM (SETTING_LIST)
+  uint8_t param;
+  uint8_t type;
+  uint8_t* color; // color of the setting group, for SKIP_COLOR_OFF & SKIP_COLOR_WHITE
+  uint8_t flags;
+  uint8_t display;
+};
+
+const static SettingItem settingItems[] PROGMEM =
+{
+  {0x10, &bgAnimation, bgAnimationList, bgAnimationNum, SETTING_LIST, NULL, ON_CHANGE_RESET_FRAME | ON_CHANGE_TRANSITION, DISPLAY_LEFT_BLINK | DYNAMIC_NONE},
+  {0x11, &bgColorIdle, bgColorList, bgColorNum, SETTING_LIST, NULL, SKIP_BG_OFF | ON_CHANGE_TRANSITION, DISPLAY_LEFT_BLINK | DYNAMIC_H},
+  {0x12, &bgSVIdle, NULL, 0, SETTING_SATURATION, &bgColorIdle, SKIP_BG_OFF | SKIP_COLOR_OFF | SKIP_COLOR_WHITE | ON_CHANGE_TRANSITION, DISPLAY_LEFT_BLINK | DYNAMIC_S},
+  {0x13, &bgSVIdle, NULL, MAX_BRIGHTNESS_BG, SETTING_BRIGHTNESS, &bgColorIdle, SKIP_BG_OFF | SKIP_COLOR_OFF | ON_CHANGE_TRANSITION, DISPLAY_LEFT_BLINK | DYNAMIC_V},
+  {0x14, &bgColorActivated, bgColorList, bgColorNum, SETTING_LIST, NULL, SKIP_NO_ACTIVATED | ON_CHANGE_TRANSITION, DISPLAY_LEFT_SWEEP | DYNAMIC_H},
+  {0x15, &bgSVActivated, NULL, 0, SETTING_SATURATION, &bgColorActivated, SKIP_NO_ACTIVATED | SKIP_COLOR_OFF | SKIP_COLOR_WHITE | ON_CHANGE_TRANSITION, DISPLAY_LEFT_SWEEP | DYNAMIC_S},
+  {0x16, &bgSVActivated, NULL, MAX_BRIGHTNESS_BG, SETTING_BRIGHTNESS, &bgColorActivated, SKIP_NO_ACTIVATED | SKIP_COLOR_OFF | ON_CHANGE_TRANSITION, DISPLAY_LEFT_SWEEP | DYNAMIC_V},
+
+  {0x20, &keyAnimation, keyAnimationList, keyAnimationNum, SETTING_LIST, NULL, ON_CHANGE_SETUP_KEY, DISPLAY_ALL_KEYS | DYNAMIC_NONE},
+  {0x21, &whiteKeyColor, keyColorList, keyColorNum, SETTING_LIST, NULL, SKIP_KEY_OFF, DISPLAY_WHITE_KEYS | DYNAMIC_H},
+  {0x22, &whiteKeySV, NULL, 0, SETTING_SATURATION, &whiteKeyColor, SKIP_KEY_OFF | SKIP_COLOR_OFF | SKIP_COLOR_WHITE, DISPLAY_WHITE_KEYS | DYNAMIC_S},
+  {0x23, &whiteKeySV, NULL, MAX_BRIGHTNESS_FG, SETTING_BRIGHTNESS, &whiteKeyColor, SKIP_KEY_OFF | SKIP_COLOR_OFF, DISPLAY_WHITE_KEYS | DYNAMIC_V},
+  {0x24, &blackKeyColor, keyColorList, keyColorNum, SETTING_LIST, NULL, SKIP_KEY_OFF, DISPLAY_BLACK_KEYS | DYNAMIC_H},
+  {0x25, &blackKeySV, NULL, 0, SETTING_SATURATION, &blackKeyColor, SKIP_KEY_OFF | SKIP_COLOR_OFF | SKIP_COLOR_WHITE, DISPLAY_BLACK_KEYS | DYNAMIC_S},
+  {0x26, &blackKeySV, NULL, MAX_BRIGHTNESS_FG, SETTING_BRIGHTNESS, &blackKeyColor, SKIP_KEY_OFF | SKIP_COLOR_OFF, DISPLAY_BLACK_KEYS | DYNAMIC_V},
+};
+const static uint8_t settingItemNum = sizeof(settingItems) / sizeof(SettingItem);
+
+bool bgHasActivatedEffect() {
+  uint8_t animationType = bgAnimation & 0xF0;
+  return animationType == 0x10 || animationType == 0x30; // driven by key alpha or playing energy
+}
+
+int8_t getSettingIndex(uint8_t status) {
+  for (uint8_t i = 0; i < settingItemNum; ++i) {
+    if (pgm_read_byte(&settingItems[i].status) == status) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool readSettingItem(uint8_t status, SettingItem& item) {
+  int8_t index = getSettingIndex(status);
+  if (index < 0) {
+    return false;
+  }
+  memcpy_P(&item, &settingItems[index], sizeof(SettingItem));
+  return true;
+}
+
+bool isSettingSkipped(const SettingItem& item) {
+  if ((item.flags & SKIP_BG_OFF) && bgAnimation == 0x00) {
+    return true;
+  }
+  if ((item.flags & SKIP_NO_ACTIVATED) && !bgHasActivatedEffect()) {
+    return true;
+  }
+  if ((item.flags & SKIP_KEY_OFF) && keyAnimation == 0x00) {
+    return true;
+  }
+  if ((item.flags & SKIP_COLOR_OFF) && *item.color == 0x00) {
+    return true;
+  }
+  if ((item.flags & SKIP_COLOR_WHITE) && *item.color == 0x01) {
+    return true;
+  }
+  return false;
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef STATS_CONTROL_H
+#define STATS_CONTROL_H
+
+#include "LEDPianoConfig.h"
+
+/*
+   Session statistics (SESSION_STATS in LEDPianoConfig.h)
+   Note on events are counted per key, per velocity range (STATS_VELOCITY_BINS) and per second (last STATS_RATE_SECONDS),
+   all counters saturate instead of wrapping. Background animation 0x40 draws the key counts as a heatmap.
+   Cost: O(1) per note on event (the highest key count is tracked on the fly), nothing per frame,
+   the heatmap only adds one multiplication per LED to the background pass.
+*/
+#ifdef SESSION_STATS
+
+#define STATS_VELOCITY_BINS 8 // velocity >> 4
+
+uint16_t keyPressCount[NUM_KEYS];
+uint16_t velocityCount[STATS_VELOCITY_BINS];
+uint8_t noteRate[STATS_RATE_SECONDS]; // notes per second, ring buffer
+uint8_t noteRateIndex = 0; // current second in noteRate[]
+uint8_t peakNoteRate = 0;
+uint32_t noteRateSecond = 0; // millis() / 1000 of noteRate[noteRateIndex]
+uint32_t totalNoteCount = 0;
+uint32_t statsStartTime = 0;
+uint16_t maxKeyPressCount = 0;
+uint16_t heatScale = 0; // 0xFF00 / maxKeyPressCount, heat = count * heatScale >> 8
+
+void resetStats() {
+  memset(keyPressCount, 0, sizeof(keyPressCount));
+  memset(velocityCount, 0, sizeof(velocityCount));
+  memset(noteRate, 0, sizeof(noteRate));
+  noteRateIndex = 0;
+  peakNoteRate = 0;
+  noteRateSecond = millis() / 1000;
+  totalNoteCount = 0;
+  statsStartTime = millis();
+  maxKeyPressCount = 0;
+  heatScale = 0;
+}
+
+void advanceNoteRate(uint32_t second) {
+  // Clear the seconds passed without notes, at most the whole ring
+  uint32_t passed = second - noteRateSecond;
+  if (passed > STATS_RATE_SECONDS) {
+    passed = STATS_RATE_SECONDS;
+  }
+  for (uint8_t i = 0; i < passed; ++i) {
+    noteRateIndex = (noteRateIndex + 1) % STATS_RATE_SECONDS;
+    noteRate[noteRateIndex] = 0;
+  }
+  noteRateSecond = second;
+}
+
+void recordNoteStats(uint8_t keyIndex, uint8_t velocity) {
+  if (keyPressCount[keyIndex] < 0xFFFF) {
+    ++keyPressCount[keyIndex];
+    if (keyPressCount[keyIndex] > maxKeyPressCount) {
+      maxKeyPressCount = keyPressCount[keyIndex];
+      heatScale = 0xFF00 / maxKeyPressCount;
+    }
+  }
+  uint8_t bin = (velocity & 0x7F) >> 4;
+  if (velocityCount[bin] < 0xFFFF) {
+    ++velocityCount[bin];
+  }
+
+  advanceNoteRate(millis() / 1000);
+  if (noteRate[noteRateIndex] < 0xFF) {
+    ++noteRate[noteRateIndex];
+    if (noteRate[noteRateIndex] > peakNoteRate) {
+      peakNoteRate = noteRate[noteRateIndex];
+    }
+  }
+  if (totalNoteCount < 0xFFFFFFFF) {
+    ++totalNoteCount;
+  }
+}
+
+uint8_t getKeyHeat(uint8_t keyIndex) { // 0 - 255, relative to the most played key
+  return uint8_t((uint32_t(keyPressCount[keyIndex]) * heatScale) >> 8);
+}
+
+void printStats() {
+  advanceNoteRate(millis() / 1000);
+  uint32_t elapsed = millis() - statsStartTime;
+  Serial.print(F("Session (s): "));
+  Serial.println(elapsed / 1000);
+  Serial.print(F("Notes: "));
+  Serial.println(totalNoteCount);
+  Serial.print(F("Notes/s average, peak: "));
+  Serial.print(elapsed ? float(totalNoteCount) * 1000.0 / float(elapsed) : 0.0);
+  Serial.print(F(" "));
+  Serial.println(peakNoteRate);
+  Serial.print(F("Notes/s (oldest first):"));
+  for (uint8_t i = 1; i <= STATS_RATE_SECONDS; ++i) {
+    Serial.print(F(" "));
+    Serial.print(noteRate[(noteRateIndex + i) % STATS_RATE_SECONDS]);
+  }
+  Serial.println();
+  Serial.println(F("Velocity: count"));
+  for (uint8_t b = 0; b < STATS_VELOCITY_BINS; ++b) {
+    Serial.print(b << 4);
+    Serial.print(F("-"));
+    Serial.print((b << 4) + 15);
+    Serial.print(F(": "));
+    Serial.println(velocityCount[b]);
+  }
+  Serial.println(F("MIDI note: count"));
+  for (uint8_t i = 0; i < NUM_KEYS; ++i) {
+    if (keyPressCount[i] > 0) {
+      Serial.print(getKeyMidi(i));
+      Serial.print(F(": "));
+      Serial.println(keyPressCount[i]);
+    }
+  }
+}
+
+#endif
+
+#endif
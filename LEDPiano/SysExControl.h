@@ -0,0 +1,206 @@
+#ifndef SYSEX_CONTROL_H
+#define SYSEX_CONTROL_H
+
+#include "ConfigStorage.h"
+#include "LookaheadControl.h"
+
+/*
+   SysEx control (SYSEX_CONFIG or LOOKAHEAD in LEDPianoConfig.h)
+   Host side encoder / decoder: /Misc/LEDPianoSysEx.py (config), /Misc/LEDPianoLookahead.py (look-ahead)
+
+   Message: 0xF0 0x7D 0x4C 0x50 command [data ...] 0xF7
+            (0x7D: non-commercial manufacturer ID, 0x4C 0x50: "LP")
+   Config bytes are sent as two 7-bit data bytes: high nibble, low nibble.
+   command 0x01: set current style, data = config (20 bytes), not saved to EEPROM
+           0x02: set slot, data = slot, config (21 bytes), current style is changed if slot is selected
+           0x03: set all slots, data = config of slot 0 - NUM_SAVE_SLOTS-1 (20 * NUM_SAVE_SLOTS bytes)
+           0x04: select slot, data = slot (1 byte), no EEPROM read
+           0x05: request dump, replies "set all slots" (0x03) via MIDIUSB (PIANO_TO_COMPUTER only)
+           0x10: commit, save current style to the selected slot and write all slots to EEPROM
+           0x20, 0x21: look-ahead schedule notes & clock sync (see LookaheadControl.h)
+   Each config is validated like loading from EEPROM, invalid values are replaced.
+   Messages with more config data than their command takes are dropped.
+*/
+#ifdef SYSEX_CONTROL
+
+#define SYSEX_SET_CURRENT 0x01
+#define SYSEX_SET_SLOT 0x02
+#define SYSEX_SET_ALL 0x03
+#define SYSEX_SELECT_SLOT 0x04
+#define SYSEX_REQUEST_DUMP 0x05
+#define SYSEX_COMMIT 0x10
+#define SYSEX_SCHEDULE_NOTES 0x20
+#define SYSEX_CLOCK_SYNC 0x21
+
+#define SYSEX_HEADER_SIZE 5 // 0xF0 0x7D 0x4C 0x50 command
+
+const static uint8_t sysExHeader[SYSEX_HEADER_SIZE - 1] PROGMEM = {0xF0, 0x7D, 0x4C, 0x50};
+
+bool sysExReceiving = false;
+uint16_t sysExIndex = 0; // index of the current byte in message
+uint8_t sysExCommand = 0;
+uint8_t sysExSlot = 0;
+uint8_t sysExConfig[CONFIG_SIZE]; // staging config, applied only when complete
+uint8_t sysExConfigIndex = 0; // received nibbles of sysExConfig
+bool sysExConfigReady = false;
+
+#ifdef SYSEX_CONFIG
+void applySysExSlot(uint8_t slot, uint8_t config[]) {
+  if (slot >= NUM_SAVE_SLOTS) {
+    return;
+  }
+  validateConfig(config);
+  storeConfigCache(slot, config);
+  if (slot == configNum) {
+    applyConfig(configCache[slot]);
+  }
+}
+
+void receiveConfigNibble(uint8_t data) {
+  if (sysExCommand == SYSEX_SET_ALL ? sysExSlot >= NUM_SAVE_SLOTS : sysExConfigReady) {
+    sysExReceiving = false; // too long, not finished at 0xF7
+    return;
+  }
+  if (sysExConfigIndex & 0x01) {
+    sysExConfig[sysExConfigIndex >> 1] |= data & 0x0F;
+  } else {
+    sysExConfig[sysExConfigIndex >> 1] = (data & 0x0F) << 4;
+  }
+  if (++sysExConfigIndex >= 2 * CONFIG_SIZE) {
+    sysExConfigIndex = 0;
+    sysExConfigReady = true;
+    if (sysExCommand == SYSEX_SET_ALL) { // store each slot once complete
+      applySysExSlot(sysExSlot++, sysExConfig);
+      sysExConfigReady = false;
+    }
+  }
+}
+
+#endif
+
+#if defined(SYSEX_CONFIG) && defined(PIANO_TO_COMPUTER)
+void sendSysEx(const uint8_t data[], uint8_t size, bool end) {
+  // size <= 3, USB-MIDI code index: 0x04 start / continue, 0x05 - 0x07 end with 1 - 3 bytes
+  midiEventPacket_t event = {uint8_t(end ? 0x04 + size : 0x04), data[0], size > 1 ? data[1] : uint8_t(0), size > 2 ? data[2] : uint8_t(0)};
+  MidiUSB.sendMIDI(event);
+}
+
+void sendConfigDump() {
+  uint8_t packet[3];
+  uint8_t packetSize = 0;
+  for (int i = 0; i < SYSEX_HEADER_SIZE - 1; ++i) {
+    packet[packetSize++] = readProgmem(&sysExHeader[i]);
+    if (packetSize == 3) { sendSysEx(packet, 3, false); packetSize = 0; }
+  }
+  packet[packetSize++] = SYSEX_SET_ALL;
+  if (packetSize == 3) { sendSysEx(packet, 3, false); packetSize = 0; }
+  for (int i = 0; i < NUM_SAVE_SLOTS; ++i) {
+    for (int j = 0; j < 2 * CONFIG_SIZE; ++j) {
+      uint8_t data = configCache[i][j >> 1];
+      packet[packetSize++] = (j & 0x01) ? (data & 0x0F) : (data >> 4);
+      if (packetSize == 3) { sendSysEx(packet, 3, false); packetSize = 0; }
+    }
+  }
+  packet[packetSize++] = 0xF7;
+  sendSysEx(packet, packetSize, true);
+  MidiUSB.flush();
+}
+#endif
+
+void finishSysEx() {
+  switch (sysExCommand) {
+#ifdef SYSEX_CONFIG
+    case SYSEX_SET_CURRENT:
+      if (sysExConfigReady) {
+        validateConfig(sysExConfig);
+        applyConfig(sysExConfig);
+      }
+      break;
+
+    case SYSEX_SET_SLOT:
+      if (sysExConfigReady) {
+        applySysExSlot(sysExSlot, sysExConfig);
+      }
+      break;
+
+    case SYSEX_SELECT_SLOT:
+      if (sysExIndex > SYSEX_HEADER_SIZE && sysExSlot < NUM_SAVE_SLOTS) {
+        configNum = sysExSlot;
+        applyConfig(configCache[configNum]);
+      }
+      break;
+
+#ifdef PIANO_TO_COMPUTER
+    case SYSEX_REQUEST_DUMP:
+      sendConfigDump();
+      break;
+#endif
+
+    case SYSEX_COMMIT:
+      getCurrentConfig(sysExConfig);
+      storeConfigCache(configNum, sysExConfig);
+      saveConfigCache();
+      saveConfigNum(configNum);
+      break;
+#endif
+
+    default: break;
+  }
+}
+
+void receiveSysExByte(uint8_t data) {
+  if (data == 0xF0) { // start
+    sysExReceiving = true;
+    sysExIndex = 0;
+    sysExSlot = 0;
+    sysExConfigIndex = 0;
+    sysExConfigReady = false;
+  }
+  if (!sysExReceiving) {
+    return;
+  }
+  if (data == 0xF7) { // end
+    sysExReceiving = false;
+    if (sysExIndex >= SYSEX_HEADER_SIZE) {
+      finishSysEx();
+    }
+    return;
+  }
+  if (sysExIndex < SYSEX_HEADER_SIZE - 1) {
+    if (data != readProgmem(&sysExHeader[sysExIndex])) {
+      sysExReceiving = false; // not for LEDPiano
+      return;
+    }
+  } else if (data & 0x80) {
+    sysExReceiving = false; // unexpected status byte
+    return;
+  } else if (sysExIndex == SYSEX_HEADER_SIZE - 1) {
+    sysExCommand = data;
+  } else if (sysExIndex == SYSEX_HEADER_SIZE && (sysExCommand == SYSEX_SET_SLOT || sysExCommand == SYSEX_SELECT_SLOT)) {
+    sysExSlot = data;
+#ifdef SYSEX_CONFIG
+  } else if (sysExCommand == SYSEX_SET_CURRENT || sysExCommand == SYSEX_SET_SLOT || sysExCommand == SYSEX_SET_ALL) {
+    receiveConfigNibble(data);
+#endif
+#ifdef LOOKAHEAD
+  } else if (sysExCommand == SYSEX_SCHEDULE_NOTES || sysExCommand == SYSEX_CLOCK_SYNC) {
+    receiveLookaheadByte(sysExCommand, sysExIndex - SYSEX_HEADER_SIZE, data);
+#endif
+  }
+  if (sysExIndex < 0xFFFF) {
+    ++sysExIndex;
+  }
+}
+
+void processSysEx(uint8_t outBuf[]) {
+  // USB-MIDI packet, code index 0x04: SysEx start / continue (3 bytes), 0x05 - 0x07: SysEx end (1 - 3 bytes)
+  uint8_t codeIndex = outBuf[0] & 0x0F;
+  uint8_t size = (codeIndex == 0x04) ? 3 : codeIndex - 0x04;
+  for (uint8_t i = 0; i < size; ++i) {
+    receiveSysExByte(outBuf[1 + i]);
+  }
+}
+
+#endif
+
+#endif
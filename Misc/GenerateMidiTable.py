@@ -1,8 +1,57 @@
+"""
+MIDI table printer & lookup table compiler for LEDPiano
+
+Usage:
+    python GenerateMidiTable.py
+        Print the MIDI code vs piano key table (/Misc/MIDI_Code_vs_Piano_Key.txt)
+    python GenerateMidiTable.py --header ../LEDPiano/LEDPianoTables.h [--num-keys 88] [--start-note 21] [--num-leds 175]
+        Generate PROGMEM lookup tables for LEDPiano (key maps, reverse pitch map, velocity/gamma/hue tables)
+        --num-leds can be replaced by --leds-per-meter & --piano-width-mm
+        Key / LED maps are only used with KEY_TABLES (custom layout), then NUM_KEYS, START_NOTE and NUM_LEDS
+        in LEDPianoConfig.h must match the generated header
+"""
+
+import argparse
+import math
+
+noteNameList = ["C", "C#/Db", "D", "D#/Eb", "E", "F", "F#/Gb", "G", "G#/Ab", "A", "A#/Bb", "B"]
+
+# Hue (0 - 255) of pure colors, index = color code (see getColorByCode())
+paletteHueList = [
+    ("off", 0),
+    ("white", 0),
+    ("red", 0),
+    ("orange", 20),
+    ("yellow", 45),
+    ("yellowGreen", 70),
+    ("green", 92),
+    ("cyan", 120),
+    ("blue", 154),
+    ("purple", 176),
+    ("magenta", 224),
+]
+
+# Start & stop color of gradient colors, index = gradient subcode (0: rainbow)
+gradientList = [
+    ("red", "red"),  # rainbow, hue range is not used
+    ("red", "yellow"),
+    ("yellow", "green"),
+    ("green", "blue"),
+    ("blue", "magenta"),
+    ("red", "green"),
+    ("yellow", "blue"),
+    ("green", "magenta"),
+]
+
+
+def getNoteName(code):
+    return noteNameList[code % 12] + str(int(code / 12) - 1)
+
+
 def printMidiTable(indent=0, gap=2, startCode=0, endCode=127, A4=440):
     headers = ["MIDI Code", "HEX Code", "Piano Key", "Note Name", "Frequency (Hz)"]
     midiTable = [headers]
     cellSize = []
-    noteNameList = ["C", "C#/Db", "D", "D#/Eb", "E", "F", "F#/Gb", "G", "G#/Ab", "A", "A#/Bb", "B"]
 
     for header in headers:
         cellSize.append(len(header))
@@ -11,9 +60,7 @@ def printMidiTable(indent=0, gap=2, startCode=0, endCode=127, A4=440):
         keyNum = code - 20
         if keyNum > 88 or keyNum < 1:
             keyNum = "--"
-        noteName = noteNameList[code % 12]
-        octave = int(code / 12) - 1
-        noteName = str(noteName) + str(octave)
+        noteName = getNoteName(code)
         freq = round(A4 * 2 ** ((code - 69) / 12), 2)
         row = [str(code), "0x{:02X}".format(code), str(keyNum), noteName, "{:.2f}".format(freq)]
         for i, cell in enumerate(row):
@@ -30,5 +77,141 @@ def printMidiTable(indent=0, gap=2, startCode=0, endCode=127, A4=440):
         print(rowStr)
 
 
+def formatArray(cType, name, size, values, perLine=12, comments=None):
+    """Format a PROGMEM array, comments (optional) is a list of (index, comment) put at line start"""
+    lines = ["const {} {}[{}] PROGMEM =".format(cType, name, size), "{"]
+    commentDict = dict(comments or [])
+    row = []
+    rowComment = None
+    for i, value in enumerate(values):
+        if (i in commentDict or len(row) >= perLine) and row:
+            lines.append("  " + ", ".join(row) + "," + (" // " + rowComment if rowComment else ""))
+            row = []
+            rowComment = None
+        if not row:
+            rowComment = commentDict.get(i)
+        row.append(str(value))
+    if row:
+        lines.append("  " + ", ".join(row) + (" // " + rowComment if rowComment else ""))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def getKeyLedMap(numKeys, numLeds):
+    # Spread keys evenly from the first to the last LED
+    if numKeys == 1:
+        return [0]
+    return [int(i * (numLeds - 1) / (numKeys - 1) + 0.5) for i in range(numKeys)]
+
+
+def getLedKeyMap(keyLedMap, numLeds):
+    # Nearest key of each LED (inverse of keyLedMap), the right key wins a tie
+    return [min(range(len(keyLedMap)), key=lambda k: (abs(keyLedMap[k] - led), -k)) for led in range(numLeds)]
+
+
+def getVelocityAlphaMap(curve):
+    # Alpha (1 - 255) by MIDI velocity (0 - 127), curve = 1.0 is linear
+    return [int(255 * (v / 127) ** curve + 0.5) | 1 for v in range(128)]
+
+
+def getGammaTable(gamma):
+    # 8-bit perceived brightness -> 16-bit linear LED output
+    return [int(65535 * (i / 255) ** gamma + 0.5) for i in range(256)]
+
+
+def generateTables(fileName, numKeys=88, startNote=21, numLeds=175, velocityCurve=1.0, gamma=2.2):
+    if startNote + numKeys > 128:
+        raise ValueError("Keyboard exceeds MIDI range")
+    if numLeds > 255 or numLeds < numKeys:
+        raise ValueError("NUM_LEDS should be in [NUM_KEYS, 255]")
+
+    keyMidiMap = list(range(startNote, startNote + numKeys))
+    keyLedMap = getKeyLedMap(numKeys, numLeds)
+    midiKeyMap = [0xFF] * 128
+    for i, code in enumerate(keyMidiMap):
+        midiKeyMap[code] = i
+    rowStarts = [i for i, code in enumerate(keyMidiMap) if i == 0 or code % 12 == 0] + [numKeys]
+    octaveComments = []
+    for k in range(len(rowStarts) - 1):
+        rowStart, rowEnd = keyMidiMap[rowStarts[k]], keyMidiMap[rowStarts[k + 1] - 1]
+        rowName = getNoteName(rowStart) + (" -> " + getNoteName(rowEnd) if rowEnd != rowStart else "")
+        octaveComments.append((rowStarts[k], rowName))
+    hueByName = dict(paletteHueList)
+
+    content = [
+        "/* Generated by /Misc/GenerateMidiTable.py, do not edit",
+        "   python GenerateMidiTable.py --header {} --num-keys {} --start-note {} --num-leds {} "
+        "--velocity-curve {} --gamma {}".format(fileName.replace("\\", "/").split("/")[-1],
+                                                 numKeys, startNote, numLeds, velocityCurve, gamma),
+        "*/",
+        "",
+        "#ifndef LED_PIANO_TABLES_H",
+        "#define LED_PIANO_TABLES_H",
+        "",
+        "#include <avr/pgmspace.h>",
+        "",
+        "#define TABLE_NUM_KEYS {}".format(numKeys),
+        "#define TABLE_START_NOTE {}".format(startNote),
+        "#define TABLE_NUM_LEDS {}".format(numLeds),
+        "",
+        "// LED number of each key (index of keyData[])",
+        formatArray("uint8_t", "keyLedMap", "TABLE_NUM_KEYS", keyLedMap, perLine=numKeys, comments=octaveComments),
+        "",
+        "// Nearest key (index of keyData[]) of each LED",
+        formatArray("uint8_t", "ledKeyMap", "TABLE_NUM_LEDS", getLedKeyMap(keyLedMap, numLeds), perLine=16),
+        "",
+        "// MIDI code of each key (index of keyData[])",
+        formatArray("uint8_t", "keyMidiMap", "TABLE_NUM_KEYS", keyMidiMap, perLine=numKeys, comments=octaveComments),
+        "",
+        "// Key (index of keyData[]) of each MIDI code, 0xFF: not on keyboard",
+        formatArray("uint8_t", "midiKeyMap", 128, midiKeyMap, perLine=16),
+        "",
+        "// Key alpha by note on velocity",
+        formatArray("uint8_t", "velocityAlphaMap", 128, getVelocityAlphaMap(velocityCurve), perLine=16),
+        "",
+        "// Gamma {}: 8-bit perceived brightness -> 16-bit linear LED output".format(gamma),
+        formatArray("uint16_t", "gammaTable", 256, getGammaTable(gamma), perLine=16),
+        "",
+        "// Hue of pure colors (color code 0x00 - 0x{:02X})".format(len(paletteHueList) - 1),
+        "#define PALETTE_HUE_NUM {}".format(len(paletteHueList)),
+        formatArray("uint8_t", "paletteHueList", "PALETTE_HUE_NUM", [hue for _, hue in paletteHueList],
+                    comments=[(i, name) for i, (name, _) in enumerate(paletteHueList)]),
+        "",
+        "// Start & stop hue of gradient colors (subcode 0x00 - 0x{:02X}, 0x00: rainbow)".format(len(gradientList) - 1),
+        "#define GRADIENT_HUE_NUM {}".format(len(gradientList)),
+        "const uint8_t gradientHueList[GRADIENT_HUE_NUM][2] PROGMEM =",
+        "{",
+    ]
+    for i, (startName, stopName) in enumerate(gradientList):
+        content.append("  {{{}, {}}}{} // {} -> {}".format(hueByName[startName], hueByName[stopName],
+                                                          "," if i < len(gradientList) - 1 else "",
+                                                          startName, stopName))
+    content += [
+        "};",
+        "",
+        "#endif",
+        "",
+    ]
+    with open(fileName, "w", newline="\n") as f:
+        f.write("\n".join(content))
+
+
 if __name__ == '__main__':
-    printMidiTable(indent=3)
\ No newline at end of file
+    parser = argparse.ArgumentParser(description="Print MIDI table or generate LEDPiano lookup tables")
+    parser.add_argument("--header", help="output header file, e.g. ../LEDPiano/LEDPianoTables.h")
+    parser.add_argument("--num-keys", type=int, default=88)
+    parser.add_argument("--start-note", type=int, default=21, help="MIDI code of the leftmost key")
+    parser.add_argument("--num-leds", type=int, default=175)
+    parser.add_argument("--leds-per-meter", type=float, help="strip density, use with --piano-width-mm")
+    parser.add_argument("--piano-width-mm", type=float, help="strip length over the keyboard")
+    parser.add_argument("--velocity-curve", type=float, default=1.0, help="1.0: linear, > 1.0: softer")
+    parser.add_argument("--gamma", type=float, default=2.2)
+    args = parser.parse_args()
+
+    if args.header:
+        ledNum = args.num_leds
+        if args.leds_per_meter and args.piano_width_mm:
+            ledNum = int(math.floor(args.piano_width_mm * args.leds_per_meter / 1000))
+        generateTables(args.header, args.num_keys, args.start_note, ledNum, args.velocity_curve, args.gamma)
+    else:
+        printMidiTable(indent=3)
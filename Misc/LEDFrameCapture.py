@@ -0,0 +1,149 @@
+"""
+LED frame capture tool for LEDPiano (FRAME_CAPTURE in LEDPianoConfig.h)
+
+Usage:
+    python LEDFrameCapture.py record <serial port> <capture file> [--baud 1000000] [--seconds 10]
+    python LEDFrameCapture.py png <capture file> <png file> [--scale 4]
+    python LEDFrameCapture.py compare <capture file> <reference capture file> [--tolerance 0]
+
+record needs pyserial (pip install pyserial), everything else only uses the standard library.
+A capture file is the raw serial stream, so host simulations can write the same format.
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+FRAME_MAGIC = b"\xA5\x5A"
+FRAME_FULL = 0x01
+FRAME_REPEAT = 0x02
+
+
+def decodeFrames(data):
+    """Return a list of (timestamp, [(r, g, b), ...]) from raw capture data, skipping broken records"""
+    frames = []
+    lastLeds = None
+    pointer = 0
+    while True:
+        pointer = data.find(FRAME_MAGIC, pointer)
+        if pointer < 0 or pointer + 9 > len(data):
+            break
+        start = pointer + 2
+        frameType = data[start]
+        timestamp = struct.unpack_from("<I", data, start + 1)[0]
+        numLeds = data[start + 5]
+        payload = start + 6
+        leds = []
+        if frameType == FRAME_FULL:
+            while len(leds) < numLeds and payload + 4 <= len(data):
+                runLength, r, g, b = data[payload:payload + 4]
+                leds.extend([(r, g, b)] * runLength)
+                payload += 4
+        elif frameType == FRAME_REPEAT:
+            leds = list(lastLeds) if lastLeds is not None else [(0, 0, 0)] * numLeds
+        if payload >= len(data) or len(leds) != numLeds or frameType not in (FRAME_FULL, FRAME_REPEAT):
+            pointer += 1  # broken record or text message, resync
+            continue
+        checksum = sum(data[start:payload]) & 0xFF
+        if checksum != data[payload]:
+            pointer += 1
+            continue
+        frames.append((timestamp, leds))
+        lastLeds = leds
+        pointer = payload + 1
+    return frames
+
+
+def readCapture(fileName):
+    with open(fileName, "rb") as f:
+        return decodeFrames(f.read())
+
+
+def writePng(fileName, rows, scale=1):
+    """Write rows of (r, g, b) pixels as an 8-bit RGB PNG, each pixel scaled to scale x scale"""
+    width = len(rows[0]) * scale
+    height = len(rows) * scale
+    raw = bytearray()
+    for row in rows:
+        line = bytearray([0])  # filter type: none
+        for pixel in row:
+            line.extend(bytes(pixel) * scale)
+        raw.extend(bytes(line) * scale)
+
+    def chunk(chunkType, chunkData):
+        body = chunkType + chunkData
+        return struct.pack(">I", len(chunkData)) + body + struct.pack(">I", zlib.crc32(body) & 0xFFFFFFFF)
+
+    with open(fileName, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(bytes(raw), 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def recordCapture(port, fileName, baud=1000000, seconds=10.0):
+    import serial
+    with serial.Serial(port, baud, timeout=0.1) as ser, open(fileName, "wb") as f:
+        stopTime = time.time() + seconds
+        while time.time() < stopTime:
+            f.write(ser.read(4096))
+
+
+def compareCaptures(frames, refFrames, tolerance=0):
+    """Compare frame by frame, return number of mismatched frames"""
+    mismatch = 0
+    if len(frames) != len(refFrames):
+        print("Frame count: {} vs {} (reference)".format(len(frames), len(refFrames)))
+    for index, ((timestamp, leds), (_, refLeds)) in enumerate(zip(frames, refFrames)):
+        if len(leds) != len(refLeds):
+            print("Frame {} ({} ms): LED count {} vs {}".format(index, timestamp, len(leds), len(refLeds)))
+            mismatch += 1
+            continue
+        maxDiff = 0
+        maxLed = 0
+        for j, (color, refColor) in enumerate(zip(leds, refLeds)):
+            diff = max(abs(a - b) for a, b in zip(color, refColor))
+            if diff > maxDiff:
+                maxDiff = diff
+                maxLed = j
+        if maxDiff > tolerance:
+            print("Frame {} ({} ms): max diff {} at LED {}".format(index, timestamp, maxDiff, maxLed))
+            mismatch += 1
+    return mismatch
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="LEDPiano frame capture tool")
+    commands = parser.add_subparsers(dest="command")
+    recordParser = commands.add_parser("record", help="record capture stream from serial port")
+    recordParser.add_argument("port")
+    recordParser.add_argument("capture")
+    recordParser.add_argument("--baud", type=int, default=1000000)
+    recordParser.add_argument("--seconds", type=float, default=10.0)
+    pngParser = commands.add_parser("png", help="decode capture into a PNG strip (one row per frame)")
+    pngParser.add_argument("capture")
+    pngParser.add_argument("png")
+    pngParser.add_argument("--scale", type=int, default=4)
+    compareParser = commands.add_parser("compare", help="compare capture against a reference capture")
+    compareParser.add_argument("capture")
+    compareParser.add_argument("reference")
+    compareParser.add_argument("--tolerance", type=int, default=0)
+    args = parser.parse_args()
+
+    if args.command == "record":
+        recordCapture(args.port, args.capture, args.baud, args.seconds)
+    elif args.command == "png":
+        captureFrames = readCapture(args.capture)
+        if not captureFrames:
+            sys.exit("No frame found in " + args.capture)
+        writePng(args.png, [leds for _, leds in captureFrames], args.scale)
+        timeSpan = captureFrames[-1][0] - captureFrames[0][0]
+        print("{} frames, {} ms".format(len(captureFrames), timeSpan))
+    elif args.command == "compare":
+        mismatchNum = compareCaptures(readCapture(args.capture), readCapture(args.reference), args.tolerance)
+        print("{} mismatched frames".format(mismatchNum))
+        sys.exit(1 if mismatchNum else 0)
+    else:
+        parser.print_help()
@@ -0,0 +1,107 @@
+"""
+LEDPiano look-ahead MIDI file player (LOOKAHEAD in LEDPianoConfig.h, protocol: LookaheadControl.h)
+
+Plays a MIDI file to the LEDPiano (Leonardo USB MIDI port) in real time, and sends each note to the LEDs
+--lead ms ahead of time, so the LEDs light up exactly on the frame the note is played.
+
+Usage:
+    python LEDPianoLookahead.py song.mid <port> [--lead 300] [--no-audio]
+    python LEDPianoLookahead.py --list
+Needs mido and python-rtmidi (pip install mido python-rtmidi).
+"""
+
+import argparse
+import time
+
+from LEDPianoSysEx import buildMessage
+
+SCHEDULE_NOTES = 0x20
+CLOCK_SYNC = 0x21
+TIME_MASK = 0x1FFFFF  # 21-bit host time in ms
+QUEUE_SIZE = 24  # LOOKAHEAD_QUEUE_SIZE
+NOTES_PER_MESSAGE = 4
+SYNC_INTERVAL = 1.0  # s
+
+
+def encodeTime(ms):
+    ms &= TIME_MASK
+    return [ms & 0x7F, (ms >> 7) & 0x7F, (ms >> 14) & 0x7F]
+
+
+def clockSyncMessage(hostMs):
+    return buildMessage(CLOCK_SYNC, encodeTime(hostMs))
+
+
+def scheduleMessage(notes):
+    """notes: list of (hostMs, isNoteOn, channel, note, velocity)"""
+    data = []
+    for hostMs, isNoteOn, channel, note, velocity in notes:
+        data += encodeTime(hostMs) + [0x09 if isNoteOn else 0x08, channel & 0x0F, note & 0x7F, velocity & 0x7F]
+    return buildMessage(SCHEDULE_NOTES, data)
+
+
+def getNoteEvents(midiFile):
+    """List of (time in s, mido message) of all non-meta messages"""
+    events = []
+    currentTime = 0.0
+    for message in midiFile:  # merged tracks, message.time in seconds
+        currentTime += message.time
+        if not message.is_meta:
+            events.append((currentTime, message))
+    return events
+
+
+def play(midiFile, port, lead, audio):
+    import mido
+    events = getNoteEvents(midiFile)
+    noteEvents = [(t, m) for t, m in events if m.type in ("note_on", "note_off")]
+    startTime = time.monotonic() + lead  # leave time to schedule the first notes
+    lastSync = -SYNC_INTERVAL
+    scheduleIndex = 0
+    inFlight = []  # scheduled times (s) not played yet, bounded by the firmware queue
+
+    def hostMs(t):
+        return int(round(t * 1000))
+
+    def sendSysEx(message):
+        port.send(mido.Message("sysex", data=message[1:-1]))
+
+    for eventTime, message in events:
+        while True:
+            now = time.monotonic() - startTime
+            if now - lastSync >= SYNC_INTERVAL:
+                sendSysEx(clockSyncMessage(hostMs(now)))
+                lastSync = now
+            inFlight = [t for t in inFlight if t > now]
+            batch = []
+            while (scheduleIndex < len(noteEvents) and noteEvents[scheduleIndex][0] - now <= lead
+                   and len(inFlight) + len(batch) < QUEUE_SIZE and len(batch) < NOTES_PER_MESSAGE):
+                t, m = noteEvents[scheduleIndex]
+                batch.append((hostMs(t), m.type == "note_on" and m.velocity > 0, m.channel, m.note, m.velocity))
+                inFlight.append(t)
+                scheduleIndex += 1
+            if batch:
+                sendSysEx(scheduleMessage(batch))
+                continue
+            if now >= eventTime:
+                break
+            time.sleep(min(0.001, eventTime - now))
+        if audio:
+            port.send(message)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Play a MIDI file with look-ahead LED scheduling")
+    parser.add_argument("file", nargs="?", help="MIDI file")
+    parser.add_argument("port", nargs="?", help="MIDI output port of LEDPiano")
+    parser.add_argument("--lead", type=float, default=300, help="look-ahead time in ms")
+    parser.add_argument("--no-audio", action="store_true", help="only send the LED schedule, not the notes")
+    parser.add_argument("--list", action="store_true", help="list MIDI output ports")
+    args = parser.parse_args()
+
+    import mido
+    if args.list or not args.file or not args.port:
+        print("Output:", mido.get_output_names())
+    else:
+        with mido.open_output(args.port) as outPort:
+            play(mido.MidiFile(args.file), outPort, args.lead / 1000, not args.no_audio)
@@ -0,0 +1,174 @@
+"""
+LEDPiano SysEx config encoder / decoder (SYSEX_CONFIG in LEDPianoConfig.h, protocol: SysExControl.h)
+
+Usage:
+    python LEDPianoSysEx.py ports
+    python LEDPianoSysEx.py send <port> set-current 01 87 C2 01 B8 01 07 AF 09 FF
+    python LEDPianoSysEx.py send <port> set-slot <slot> 01 87 C2 01 B8 01 07 AF 09 FF
+    python LEDPianoSysEx.py send <port> select <slot>
+    python LEDPianoSysEx.py send <port> commit
+    python LEDPianoSysEx.py dump <port in> <port out>
+    python LEDPianoSysEx.py encode set-current 01 87 C2 01 B8 01 07 AF 09 FF
+
+Config bytes are hex, in the same order as defaultConfig[] in LEDPianoConfig.h.
+send / dump need mido and python-rtmidi (pip install mido python-rtmidi).
+Tests: python LEDPianoSysExTest.py
+"""
+
+import sys
+
+SYSEX_START = 0xF0
+SYSEX_END = 0xF7
+HEADER = [0x7D, 0x4C, 0x50]  # non-commercial manufacturer ID, "LP"
+
+SET_CURRENT = 0x01
+SET_SLOT = 0x02
+SET_ALL = 0x03
+SELECT_SLOT = 0x04
+REQUEST_DUMP = 0x05
+COMMIT = 0x10
+
+CONFIG_SIZE = 10
+NUM_SAVE_SLOTS = 5
+CONFIG_FIELDS = ["bgAnimation", "bgColorIdle", "bgSVIdle", "bgColorActivated", "bgSVActivated",
+                 "keyAnimation", "whiteKeyColor", "whiteKeySV", "blackKeyColor", "blackKeySV"]
+
+
+def encodeConfig(config):
+    if len(config) != CONFIG_SIZE or any(not 0 <= data <= 0xFF for data in config):
+        raise ValueError("Config should be {} bytes".format(CONFIG_SIZE))
+    nibbles = []
+    for data in config:
+        nibbles += [data >> 4, data & 0x0F]
+    return nibbles
+
+
+def decodeConfig(nibbles):
+    if len(nibbles) != 2 * CONFIG_SIZE or any(not 0 <= data <= 0x0F for data in nibbles):
+        raise ValueError("Config should be {} nibbles".format(2 * CONFIG_SIZE))
+    return [(nibbles[i] << 4) | nibbles[i + 1] for i in range(0, len(nibbles), 2)]
+
+
+def buildMessage(command, data=()):
+    return bytes([SYSEX_START] + HEADER + [command] + list(data) + [SYSEX_END])
+
+
+def setCurrentMessage(config):
+    return buildMessage(SET_CURRENT, encodeConfig(config))
+
+
+def checkSlot(slot):
+    if not 0 <= slot < NUM_SAVE_SLOTS:
+        raise ValueError("Slot should be 0 - {}".format(NUM_SAVE_SLOTS - 1))
+    return slot
+
+
+def setSlotMessage(slot, config):
+    return buildMessage(SET_SLOT, [checkSlot(slot)] + encodeConfig(config))
+
+
+def setAllMessage(configs):
+    data = []
+    for config in configs:
+        data += encodeConfig(config)
+    return buildMessage(SET_ALL, data)
+
+
+def selectSlotMessage(slot):
+    return buildMessage(SELECT_SLOT, [checkSlot(slot)])
+
+
+def requestDumpMessage():
+    return buildMessage(REQUEST_DUMP)
+
+
+def commitMessage():
+    return buildMessage(COMMIT)
+
+
+def decodeMessage(message):
+    """Decode a full SysEx message into a dict: {"command", "slot", "configs"}, None if not for LEDPiano"""
+    message = list(message)
+    if len(message) < 6 or message[0] != SYSEX_START or message[-1] != SYSEX_END or message[1:4] != HEADER:
+        return None
+    command = message[4]
+    data = message[5:-1]
+    result = {"command": command, "slot": None, "configs": []}
+    if command in (SET_SLOT, SELECT_SLOT):
+        if not data:
+            raise ValueError("Missing slot")
+        result["slot"] = data[0]
+        data = data[1:]
+    if command in (SET_CURRENT, SET_SLOT, SET_ALL):
+        configNibbles = 2 * CONFIG_SIZE
+        if len(data) % configNibbles or (command != SET_ALL and len(data) != configNibbles):
+            raise ValueError("Incomplete config")
+        for i in range(0, len(data), configNibbles):
+            result["configs"].append(decodeConfig(data[i:i + configNibbles]))
+    return result
+
+
+def toUsbMidiPackets(message):
+    """Split a SysEx message into 4-byte USB-MIDI event packets (as received by processMidi())"""
+    packets = []
+    for i in range(0, len(message), 3):
+        chunk = list(message[i:i + 3])
+        end = i + 3 >= len(message)
+        codeIndex = 0x04 + len(chunk) if end else 0x04
+        packets.append(bytes([codeIndex] + chunk + [0] * (3 - len(chunk))))
+    return packets
+
+
+def formatConfig(config):
+    return ", ".join("{}=0x{:02X}".format(name, data) for name, data in zip(CONFIG_FIELDS, config))
+
+
+def parseCommand(args):
+    if not args:
+        raise ValueError("Missing command")
+    name, args = args[0], args[1:]
+    if name == "set-current":
+        return setCurrentMessage([int(a, 16) for a in args])
+    if name == "set-slot":
+        return setSlotMessage(int(args[0]), [int(a, 16) for a in args[1:]])
+    if name == "set-all":
+        data = [int(a, 16) for a in args]
+        return setAllMessage([data[i:i + CONFIG_SIZE] for i in range(0, len(data), CONFIG_SIZE)])
+    if name == "select":
+        return selectSlotMessage(int(args[0]))
+    if name == "commit":
+        return commitMessage()
+    if name == "request-dump":
+        return requestDumpMessage()
+    raise ValueError("Unknown command: " + name)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    action = sys.argv[1]
+    if action == "encode":
+        print(" ".join("{:02X}".format(b) for b in parseCommand(sys.argv[2:])))
+    elif action == "ports":
+        import mido
+        print("Input:", mido.get_input_names())
+        print("Output:", mido.get_output_names())
+    elif action == "send":
+        import mido
+        message = parseCommand(sys.argv[3:])
+        with mido.open_output(sys.argv[2]) as port:
+            port.send(mido.Message("sysex", data=message[1:-1]))
+    elif action == "dump":
+        import mido
+        with mido.open_input(sys.argv[2]) as inPort, mido.open_output(sys.argv[3]) as outPort:
+            outPort.send(mido.Message("sysex", data=requestDumpMessage()[1:-1]))
+            for midiMessage in inPort:
+                if midiMessage.type != "sysex":
+                    continue
+                decoded = decodeMessage(bytes([SYSEX_START] + list(midiMessage.data) + [SYSEX_END]))
+                if decoded and decoded["command"] == SET_ALL:
+                    for slot, config in enumerate(decoded["configs"]):
+                        print("slot{}: {}".format(slot, formatConfig(config)))
+                    break
+    else:
+        sys.exit(__doc__)
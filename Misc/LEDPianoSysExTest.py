@@ -0,0 +1,143 @@
+"""
+Tests of LEDPianoSysEx.py (no MIDI port or mido needed)
+
+Usage:
+    python LEDPianoSysExTest.py
+
+USB-MIDI packets are reassembled by the same rule as processSysEx() in /LEDPiano/SysExControl.h:
+code index 0x04 carries 3 bytes (start / continue), 0x05 - 0x07 end the message with 1 - 3 bytes.
+"""
+
+import unittest
+
+from LEDPianoSysEx import (CONFIG_SIZE, NUM_SAVE_SLOTS, SET_CURRENT, SET_SLOT, SET_ALL, SELECT_SLOT, REQUEST_DUMP,
+                           COMMIT, SYSEX_START, SYSEX_END, HEADER, encodeConfig, decodeConfig, buildMessage,
+                           setCurrentMessage, setSlotMessage, setAllMessage, selectSlotMessage, requestDumpMessage,
+                           commitMessage, decodeMessage, toUsbMidiPackets, parseCommand)
+
+CONFIG = [0x01, 0x87, 0xC2, 0x01, 0xB8, 0x01, 0x07, 0xAF, 0x09, 0xFF]  # defaultConfig[] of slot 0
+
+
+def receivePackets(packets):
+    """Bytes of a SysEx message as processSysEx() reads them, fails on packets it would not accept"""
+    message = []
+    for i, packet in enumerate(packets):
+        if len(packet) != 4:
+            raise AssertionError("Packet {} is not 4 bytes".format(i))
+        codeIndex = packet[0] & 0x0F
+        if i < len(packets) - 1 and codeIndex != 0x04:
+            raise AssertionError("Packet {} ends the message early".format(i))
+        if i == len(packets) - 1 and codeIndex not in (0x05, 0x06, 0x07):
+            raise AssertionError("Last packet does not end the message")
+        size = 3 if codeIndex == 0x04 else codeIndex - 0x04
+        if any(packet[1 + size:]):
+            raise AssertionError("Packet {} is not padded with 0".format(i))
+        message += list(packet[1:1 + size])
+    return message
+
+
+class ConfigTest(unittest.TestCase):
+    def testRoundTrip(self):
+        for config in (CONFIG, [0x00] * CONFIG_SIZE, [0xFF] * CONFIG_SIZE, list(range(0x10, 0xB0, 0x10))):
+            nibbles = encodeConfig(config)
+            self.assertEqual(len(nibbles), 2 * CONFIG_SIZE)
+            self.assertTrue(all(0 <= data <= 0x0F for data in nibbles))  # 7-bit SysEx data
+            self.assertEqual(decodeConfig(nibbles), config)
+
+    def testHostCheckMessages(self):
+        # checkSysEx() in /Host/HostCheck.cpp feeds these bytes to the sketch
+        self.assertEqual(setCurrentMessage(CONFIG).hex(), "f07d4c5001000108070c0200010b08000100070a0f00090f0ff7")
+        self.assertEqual(setSlotMessage(1, CONFIG).hex(), "f07d4c500201000108070c0200010b08000100070a0f00090f0ff7")
+        self.assertEqual(selectSlotMessage(1).hex(), "f07d4c500401f7")
+
+    def testNibbleOrder(self):
+        self.assertEqual(encodeConfig(CONFIG)[:4], [0x0, 0x1, 0x8, 0x7])  # high nibble first
+
+    def testInvalidConfig(self):
+        for config in (CONFIG[:-1], CONFIG + [0x00], CONFIG[:-1] + [0x100], CONFIG[:-1] + [-1]):
+            with self.assertRaises(ValueError):
+                encodeConfig(config)
+        nibbles = encodeConfig(CONFIG)
+        for invalid in (nibbles[:-1], nibbles + [0x0], nibbles[:-1] + [0x10]):
+            with self.assertRaises(ValueError):
+                decodeConfig(invalid)
+
+
+class MessageTest(unittest.TestCase):
+    def testFraming(self):
+        message = setCurrentMessage(CONFIG)
+        self.assertEqual(message[0], SYSEX_START)
+        self.assertEqual(list(message[1:4]), HEADER)
+        self.assertEqual(message[4], SET_CURRENT)
+        self.assertEqual(message[-1], SYSEX_END)
+        self.assertTrue(all(data < 0x80 for data in message[1:-1]))
+
+    def testDecodeEveryCommand(self):
+        configs = [[(slot * 0x11 + i) & 0xFF for i in range(CONFIG_SIZE)] for slot in range(NUM_SAVE_SLOTS)]
+        cases = [
+            (setCurrentMessage(CONFIG), SET_CURRENT, None, [CONFIG]),
+            (setSlotMessage(3, CONFIG), SET_SLOT, 3, [CONFIG]),
+            (setAllMessage(configs), SET_ALL, None, configs),
+            (selectSlotMessage(NUM_SAVE_SLOTS - 1), SELECT_SLOT, NUM_SAVE_SLOTS - 1, []),
+            (requestDumpMessage(), REQUEST_DUMP, None, []),
+            (commitMessage(), COMMIT, None, []),
+        ]
+        for message, command, slot, decodedConfigs in cases:
+            decoded = decodeMessage(message)
+            self.assertEqual(decoded, {"command": command, "slot": slot, "configs": decodedConfigs})
+
+    def testParseCommand(self):
+        args = ["{:02X}".format(data) for data in CONFIG]
+        self.assertEqual(parseCommand(["set-current"] + args), setCurrentMessage(CONFIG))
+        self.assertEqual(parseCommand(["set-slot", "2"] + args), setSlotMessage(2, CONFIG))
+        self.assertEqual(parseCommand(["select", "1"]), selectSlotMessage(1))
+        self.assertEqual(parseCommand(["commit"]), commitMessage())
+        with self.assertRaises(ValueError):
+            parseCommand(["reset"])
+
+    def testForeignMessage(self):
+        message = list(setCurrentMessage(CONFIG))
+        for header in ([0x7D, 0x4C, 0x51], [0x7E, 0x4C, 0x50], [0x43, 0x10, 0x4C]):  # other ID / universal / Yamaha
+            self.assertIsNone(decodeMessage(bytes([SYSEX_START] + header + message[4:])))
+        self.assertIsNone(decodeMessage(message[:-1]))  # no end
+        self.assertIsNone(decodeMessage(message[1:]))  # no start
+        self.assertIsNone(decodeMessage(bytes([SYSEX_START] + HEADER + [SYSEX_END])))  # no command
+
+    def testInvalidMessage(self):
+        with self.assertRaises(ValueError):
+            setSlotMessage(NUM_SAVE_SLOTS, CONFIG)
+        with self.assertRaises(ValueError):
+            selectSlotMessage(-1)
+        with self.assertRaises(ValueError):
+            setAllMessage([CONFIG, CONFIG[:-1]])
+        nibbles = encodeConfig(CONFIG)
+        for message in (buildMessage(SET_CURRENT, nibbles[:-1]),  # torn config
+                        buildMessage(SET_CURRENT, nibbles + nibbles),  # two configs
+                        buildMessage(SET_ALL, nibbles + nibbles[:2]),
+                        buildMessage(SET_SLOT),  # no slot
+                        buildMessage(SET_CURRENT, nibbles[:-1] + [0x10])):  # not a nibble
+            with self.assertRaises(ValueError):
+                decodeMessage(message)
+
+
+class UsbMidiTest(unittest.TestCase):
+    def testCodeIndex(self):
+        # The last packet carries size % 3 bytes (3 if 0): code index 0x04 + that
+        for size, endCodeIndex in ((6, 0x07), (7, 0x05), (26, 0x06), (27, 0x07), (8, 0x06)):
+            message = buildMessage(COMMIT, [0x00] * (size - 6))
+            packets = toUsbMidiPackets(message)
+            self.assertEqual(len(packets), (size + 2) // 3)
+            self.assertTrue(all(packet[0] == 0x04 for packet in packets[:-1]))
+            self.assertEqual(packets[-1][0], endCodeIndex)
+
+    def testReassemble(self):
+        configs = [CONFIG] * NUM_SAVE_SLOTS
+        for message in (setCurrentMessage(CONFIG), setSlotMessage(0, CONFIG), setAllMessage(configs),
+                        selectSlotMessage(2), requestDumpMessage(), commitMessage()):
+            received = receivePackets(toUsbMidiPackets(message))
+            self.assertEqual(received, list(message))
+            self.assertEqual(decodeMessage(bytes(received)), decodeMessage(message))
+
+
+if __name__ == '__main__':
+    unittest.main()
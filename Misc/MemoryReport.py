@@ -0,0 +1,60 @@
+"""
+SRAM / flash usage report of a compiled LEDPiano sketch
+
+Usage:
+    python MemoryReport.py LEDPiano.ino.elf [--top 20] [--sram 2048] [--flash 32256] [--nm avr-nm]
+        LEDPiano.ino.elf: Arduino IDE "Sketch > Export compiled Binary" (or the build folder with verbose output)
+        --sram / --flash: budget of your board (UNO: 2048 / 32256, Leonardo: 2560 / 28672)
+
+Static SRAM = .data (initialized variables, also stored in flash) + .bss (zero-initialized variables),
+the rest of SRAM is shared by heap and stack. Run "p" in the PROFILE serial shell for free / never used SRAM at runtime.
+"""
+
+import argparse
+import subprocess
+
+# nm symbol type -> region
+SRAM_TYPES = {"d": ".data", "b": ".bss"}
+FLASH_TYPES = {"t": ".text", "r": ".rodata", "w": ".text"}
+
+
+def readSymbols(elfFile, nm):
+    output = subprocess.run([nm, "--size-sort", "-S", "-C", elfFile], check=True,
+                            stdout=subprocess.PIPE, universal_newlines=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) < 4:
+            continue
+        size = int(parts[1], 16)
+        symbolType = parts[2].lower()
+        symbols.append((parts[3], symbolType, size))
+    return symbols
+
+
+def printRegion(title, symbols, budget, top):
+    total = sum(size for _, _, size in symbols)
+    print("{}: {} bytes{}".format(title, total,
+                                 " ({:.1f}% of {})".format(100.0 * total / budget, budget) if budget else ""))
+    for name, section, size in sorted(symbols, key=lambda s: -s[2])[:top]:
+        print("  {:>6}  {:<8} {}".format(size, section, name))
+    return total
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Print SRAM & flash usage by symbol")
+    parser.add_argument("elf", help="compiled sketch (.elf)")
+    parser.add_argument("--top", type=int, default=20, help="number of symbols listed for each region")
+    parser.add_argument("--sram", type=int, default=2048, help="SRAM size of the board")
+    parser.add_argument("--flash", type=int, default=32256, help="flash size of the board (without bootloader)")
+    parser.add_argument("--nm", default="avr-nm", help="nm of the toolchain")
+    args = parser.parse_args()
+
+    allSymbols = readSymbols(args.elf, args.nm)
+    sramSymbols = [(n, SRAM_TYPES[t], s) for n, t, s in allSymbols if t in SRAM_TYPES]
+    flashSymbols = [(n, FLASH_TYPES[t], s) for n, t, s in allSymbols if t in FLASH_TYPES]
+
+    sramTotal = printRegion("Static SRAM", sramSymbols, args.sram, args.top)
+    print("  Left for heap & stack: {} bytes".format(args.sram - sramTotal))
+    print()
+    printRegion("Flash (code & PROGMEM)", flashSymbols, args.flash, args.top)